@@ -145,6 +145,17 @@ BOOL aestrap_intercepted(void)
 {
     return ((LONG)VEC_AES) < os_beg || ((LONG)VEC_AES) >= ((LONG)_etext);
 }
+
+/*
+* determine if the VDI that the AES chains to is not the ROM one
+* (e.g. NVDI was installed before the AES)
+*
+* return 1 if so, else 0
+*/
+BOOL vditrap_intercepted(void)
+{
+    return ((LONG)savetrap2) < os_beg || ((LONG)savetrap2) >= ((LONG)_etext);
+}
 #if 0
 
 
@@ -23,7 +23,13 @@
 extern AESPD    *rlr;
 
 extern AESPD    *drl, *nrl;
-extern EVB      *eul, *dlr, *zlr;
+extern EVB      *eul, *zlr;
+
+/* Delay heap - the pending MU_TIMER events, earliest deadline first
+ * [see geminput.c function adelay]
+ */
+extern EVB      *dlheap[NUM_PDS];
+extern WORD     dlcnt;
 
 /* In Dispatch - a byte whose value is zero when not in function
  * dsptch, and 1 when between dsptch ... switchto function calls
@@ -32,6 +38,8 @@ extern BYTE     indisp;
 
 extern WORD     fpt, fph, fpcnt;                /* forkq tail, head,    */
                                                 /*   count              */
+extern UWORD    fpovf;                          /* forks dropped, ring full */
+extern UWORD    kqovf;                          /* keys dropped, queue full */
 extern SPB      wind_spb;
 extern CDA      *cda;
 extern WORD     curpid;
@@ -29,6 +29,7 @@
 #include "geminput.h"
 #include "gemflag.h"
 #include "gemevlib.h"
+#include "gemqueue.h"
 #include "gemgsxif.h"
 #include "gemwmlib.h"
 #include "gemmnlib.h"
@@ -84,8 +85,7 @@ WORD ap_rdwr(WORD code, AESPD *p, WORD length, WORD *pbuff)
      */
     if ((code == MU_MESAG) && (p->p_qindex == length) && (length == 16))
     {
-        memcpy(pbuff, p->p_qaddr, p->p_qindex);
-        p->p_qindex = 0;
+        q_read(p, (BYTE *)pbuff, length);
         return 0;
     }
 
@@ -250,8 +250,7 @@ void ap_exit(void)
     wm_update(BEG_UPDATE);
     mn_clsda();
     wait_for_accs(AP_ACCLOSE);  /* block until all DAs have seen AC_CLOSE */
-    if (rlr->p_qindex)
-        ap_rdwr(MU_MESAG, rlr, rlr->p_qindex, (WORD *)D.g_valstr);
+    q_flush(rlr);
     set_mouse_to_arrow();
     wm_update(END_UPDATE);
     all_run();
@@ -96,19 +96,14 @@ void evinsert(EVB *e, EVB **root)
 
 static void takeoff(EVB *p)
 {
-    LONG c;
-
-    /* take event p off e_link list, must be NODISP */
-    p->e_pred->e_link = p->e_link;
-    if (p->e_link)
+    /* take event p off its list, must be NODISP */
+    if (p->e_flag & EVDELAY)
+        dlcancel(p);
+    else
     {
-        p->e_link->e_pred = p->e_pred;
-        if (p->e_flag & EVDELAY)
-        {
-            c = p->e_link->e_parm;
-            c += p->e_parm;
-            p->e_link->e_parm = c;
-        }
+        p->e_pred->e_link = p->e_link;
+        if (p->e_link)
+            p->e_link->e_pred = p->e_pred;
     }
     p->e_nextp = eul;
     eul = p;
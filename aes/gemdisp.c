@@ -32,15 +32,18 @@
 #include "geminput.h"
 #include "gempd.h"
 #include "gemgsxif.h"
+#include "gemgraf.h"
 #include "gemaplib.h"
 #include "geminit.h"
 #include "gemflag.h"
 #include "gemasm.h"
 #include "optimize.h"
 #include "gemdosif.h"
+#include "gemevlib.h"
 #include "kprint.h"
 
 #include "asm.h"
+#include "biosext.h"
 
 #define KEYMASK 0xffff0000L             /* for comparing data to KEYSTOP */
 #define KEYSTOP 0x2b1c0000L             /* control-backslash */
@@ -55,8 +58,23 @@ void forkq(FCODE fcode, LONG fdata)
     /* q a fork process, enter with ints OFF */
     if (fpcnt == 0)
         fpt = fph = 0;
+    else if (fcode == mchange)
+    {
+        /*
+         * if the last fork queued is a mouse motion that has not been
+         * handled yet, the new position simply replaces it
+         */
+        f = &D.g_fpdx[(fpt ? fpt : NFORKS) - 1];
+        if (f->f_code == mchange)
+        {
+            f->f_data = fdata;
+            return;
+        }
+    }
 
-    if (fpcnt < NFORKS)
+    if (fpcnt >= NFORKS)
+        fpovf++;
+    else
     {
         f = &D.g_fpdx[fpt++];
         if (fpt == NFORKS)      /* wrap pointer around  */
@@ -100,6 +118,20 @@ void forker(void)
 
     oldrl = rlr;
     rlr = (AESPD *) -1;
+
+#ifdef ENABLE_KDEBUG
+    {
+        static UWORD reported_fpovf, reported_kqovf;
+
+        if ((fpovf != reported_fpovf) || (kqovf != reported_kqovf))
+        {
+            KDEBUG(("forker(): %u forks and %u keys dropped so far\n", fpovf, kqovf));
+            reported_fpovf = fpovf;
+            reported_kqovf = kqovf;
+        }
+    }
+#endif
+
     while(fpcnt)
     {
         /* critical area        */
@@ -133,7 +165,7 @@ void forker(void)
                 }
                 else
                 {
-                    memcpy(gl_rbuf, f, sizeof(FPD));
+                    memcpy(gl_rbuf, &g, sizeof(FPD));
                     gl_rbuf++;
                     gl_rlen--;
                     if (gl_rlen <= 0)
@@ -172,6 +204,27 @@ void chkkbd(void)
 }
 
 
+#if CONF_WITH_TICKLESS_IDLE
+/*
+ * How long the AES can sleep, in 200 Hz ticks, without missing the end
+ * of an evnt_timer() or of a button click delay; 0 if neither is pending.
+ * Both count calls of the 50 Hz timer tick, the next of which may be as
+ * little as one 200 Hz tick away.  Called with interrupts disabled.
+ */
+static ULONG idle_ticks(void)
+{
+    LONG n = CMP_TICK;
+
+    if (gl_bdely > 0 && (n == 0 || gl_bdely < n))
+        n = gl_bdely;
+    if (n == 0)
+        return 0;
+
+    return (n - 1) * (gl_ticktime / 5) + 1;
+}
+#endif
+
+
 static void schedule(void)
 {
     AESPD *p;
@@ -192,7 +245,13 @@ static void schedule(void)
         /* check if there is something to run */
         if (rlr || fpcnt)
             break;
-#if USE_STOP_INSN_TO_FREE_HOST_CPU
+#if CONF_WITH_TICKLESS_IDLE
+        /* an interrupt that forks now still ends the wait */
+        disable_interrupts();
+        if (!fpcnt)
+            tickless_idle(idle_ticks());
+        enable_interrupts();
+#elif USE_STOP_INSN_TO_FREE_HOST_CPU
         stop_until_interrupt();
 #endif
     }
@@ -221,6 +280,9 @@ void disp(void)
     rlr = p->p_link;
     KDEBUG(("disp() to \"%8s\"\n", rlr->p_name));
 
+    /* whoever ran before may have changed the VDI clip */
+    gsx_forgetclip();
+
     /* based on the state of the process p, do something */
     if (p->p_stat & WAITIN)
         mwait_act(p);
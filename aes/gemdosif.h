@@ -35,6 +35,7 @@ extern void justretf(void);
 extern void unset_aestrap(void);
 extern void set_aestrap(void);
 extern BOOL aestrap_intercepted(void);
+extern BOOL vditrap_intercepted(void);
 
 extern void takeerr(void);
 extern void giveerr(void);
@@ -32,45 +32,6 @@
 
 
 
-void tchange(LONG c)            /* c=number of ticks that have gone by  */
-{
-    EVB *d;
-    LONG c1;
-
-    /*
-     * pull pd's off the delay list that have waited long enough
-     */
-    d = dlr;
-    while (d)
-    {
-        /* take a bite out of the amount of time the pd is waiting */
-        c1 = c - d->e_parm;
-        d->e_parm -= c;
-        c = c1;
-
-        /* finished waiting? */
-        if (d->e_parm <= 0L)
-        {
-            d->e_parm = 0L;
-            evremove(d, 0);
-            d = dlr;
-        }
-        else
-        {
-            /*
-             * set compare tick time to the amount the
-             * first guy is waiting
-             */
-            disable_interrupts();
-            CMP_TICK = d->e_parm;
-            NUM_TICK = 0L;
-            enable_interrupts();
-            break;
-        }
-    }
-}
-
-
 WORD tak_flag(SPB *sy)
 {
     /* count up */
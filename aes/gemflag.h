@@ -10,7 +10,6 @@
 #ifndef GEMFLAG_H
 #define GEMFLAG_H
 
-void tchange(LONG c);
 WORD tak_flag(SPB *sy);
 void amutex(EVB *e, LONG ls);
 void unsync(SPB *sy);
@@ -53,10 +53,35 @@ static GRECT gl_rfs;
 
 static const BYTE gl_fsobj[4] = {FTITLE, FILEBOX, SCRLBAR, 0x0};
 
-static BYTE *ad_fsnames;    /* holds filenames in currently-displayed directory */
+/*
+ * Directory listings are cached for the duration of an fs_input() call,
+ * so that editing the mask, or returning to a folder that has already
+ * been visited, doesn't read the directory again.  A listing holds all
+ * the files of a directory, sorted by name; the mask is applied when the
+ * list is displayed.  The listings share one buffer: when it is full,
+ * they are all discarded and the buffer is refilled from the start.
+ * Nothing else can change a directory while the dialog is up, except the
+ * user swapping disks, so the cache is also flushed on a drive change.
+ */
+#define NM_DIRS     8               /* max number of cached directories */
+#define FS_FULL     1L              /* fs_read() ran out of slots */
+
+typedef struct {
+    LONG path;                      /* offset of directory path within ad_fsnames */
+    LONG first;                     /* index of first entry in g_fslist[] */
+    LONG count;                     /* number of entries */
+} FSDIR;
+
+static BYTE *ad_fsnames;    /* holds paths & filenames of cached directories */
 static LONG *g_fslist;      /* offsets of filenames within ad_fsnames */
+static LONG *g_fsview;      /* offsets of filenames currently displayed */
 static LONG nm_files;       /* total number of slots in g_fslist[] */
 
+static FSDIR fs_dirs[NM_DIRS];
+static WORD nm_dirs;        /* number of entries in fs_dirs[] */
+static LONG fs_nxtname;     /* first free byte in ad_fsnames */
+static LONG fs_nxtfile;     /* first free slot in g_fslist[] */
+
 
 /*
  *  initialise the file selector
@@ -169,28 +194,88 @@ static LONG fs_add(WORD thefile, LONG fs_index)
 
 
 /*
- *  Make a particular path the active path.  This involves
- *  reading its directory, initializing a file list, and filling
- *  out the information in the path node.  Then sort the files.
+ *  Sort n entries of g_fslist[] by name, using a bottom-up merge sort
+ *  with g_fsview[] as scratch space
+ */
+static void fs_sort(LONG *list, LONG n)
+{
+    LONG *src = list, *dst = g_fsview, *tmp;
+    LONG width, lo, mid, hi, i, j, k;
+
+    for (width = 1; width < n; width *= 2)
+    {
+        for (lo = 0; lo < n; lo += 2*width)
+        {
+            mid = (lo + width < n) ? lo + width : n;
+            hi = (lo + 2*width < n) ? lo + 2*width : n;
+            for (i = lo, j = mid, k = lo; k < hi; k++)
+            {
+                if ((i < mid) && ((j >= hi) || (fs_comp(ad_fsnames+src[i],ad_fsnames+src[j]) <= 0)))
+                    dst[k] = src[i++];
+                else
+                    dst[k] = src[j++];
+            }
+        }
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != list)
+        memcpy(list, src, n*sizeof(LONG));
+}
+
+
+/*
+ *  Discard all cached directory listings
+ */
+static void fs_flush(void)
+{
+    nm_dirs = 0;
+    fs_nxtname = 0L;
+    fs_nxtfile = 0L;
+}
+
+
+/*
+ *  Find the cached listing for a directory path (ending in a backslash)
  *
- *  Returns FALSE iff error occurred
+ *  Returns NULL if the directory is not cached
  */
-static WORD fs_active(BYTE *ppath, BYTE *pspec, WORD *pcount)
+static FSDIR *fs_find(BYTE *path)
 {
-    WORD ret;
-    LONG thefile, fs_index, temp;
-    WORD i, j, gap;
-    BYTE *fname, allpath[LEN_ZPATH+1];
-    DTA *user_dta;
+    FSDIR *dir;
+
+    for (dir = fs_dirs; dir < fs_dirs+nm_dirs; dir++)
+    {
+        if (strcmp(ad_fsnames+dir->path, path) == 0)
+            return dir;
+    }
+
+    return NULL;
+}
 
-    set_mouse_to_hourglass();
 
-    thefile = 0L;
-    fs_index = 0L;
+/*
+ *  Read a directory into the free part of the buffers, and sort it.
+ *  If pspec is not NULL, only folders & the files matching pspec are
+ *  kept.  On return, *pend is the offset of the first unused byte of
+ *  ad_fsnames.
+ *
+ *  Returns the GEMDOS error code that ended the search, or FS_FULL
+ */
+static LONG fs_read(BYTE *path, BYTE *pspec, FSDIR *dir, LONG *pend)
+{
+    LONG ret, thefile, fs_index;
+    BYTE allpath[LEN_ZPATH+4];
+    DTA *user_dta;
+
+    dir->path = fs_nxtname;
+    fs_index = fs_nxtname + strlencpy(ad_fsnames+fs_nxtname, path) + 1;
+    dir->first = thefile = fs_nxtfile;
 
-    strcpy(allpath, ppath);         /* 'allpath' gets all files */
-    fname = fs_pspec(allpath,NULL);
-    strcpy(fname,"*.*");
+    strcpy(allpath, path);          /* 'allpath' gets all files */
+    strcat(allpath, "*.*");
 
     user_dta = dos_gdta();          /* remember user's DTA */
     dos_sdta(&D.g_dta);
@@ -203,49 +288,114 @@ static WORD fs_active(BYTE *ppath, BYTE *pspec, WORD *pcount)
          */
         if (D.g_dta.d_fname[0] != '.')
         {
-            if ((D.g_dta.d_attrib & F_SUBDIR) || (wildcmp(pspec, D.g_dta.d_fname)))
+            if (!pspec || (D.g_dta.d_attrib & F_SUBDIR) || (wildcmp(pspec, D.g_dta.d_fname)))
             {
+                if (thefile >= nm_files)    /* too many files */
+                {
+                    ret = FS_FULL;
+                    break;
+                }
                 fs_index = fs_add(thefile, fs_index);
                 thefile++;
             }
         }
         ret = dos_snext();
-
-        if (thefile >= nm_files)    /* too many files */
-        {
-            sound(TRUE, 660, 4);
-            break;
-        }
     }
 
-    *pcount = thefile;
     dos_sdta(user_dta);             /* restore user DTA */
 
-    /* sort files using shell sort from page 108 of K&R C Prog. Lang. */
-    for (gap = thefile/2; gap > 0; gap /= 2)
+    dir->count = thefile - dir->first;
+    *pend = fs_index;
+    fs_sort(g_fslist+dir->first, dir->count);
+
+    return ret;
+}
+
+
+/*
+ *  Read a directory and add it to the cache, flushing the cache first
+ *  if there is not enough room.  If the directory doesn't fit even in
+ *  the empty buffers, only the files matching pspec are read, and the
+ *  listing is not cached.
+ *
+ *  Returns the GEMDOS error code that ended the search
+ */
+static LONG fs_load(BYTE *path, BYTE *pspec, FSDIR *dir)
+{
+    LONG ret, end;
+
+    if (nm_dirs >= NM_DIRS)
+        fs_flush();
+
+    while ((ret = fs_read(path, NULL, dir, &end)) == FS_FULL)
     {
-        for (i = gap; i < thefile; i++)
+        if (nm_dirs == 0)
         {
-            for (j = i-gap; j >= 0; j -= gap)
+            ret = fs_read(path, pspec, dir, &end);
+            if (ret == FS_FULL)
             {
-                if (fs_comp(ad_fsnames+g_fslist[j],ad_fsnames+g_fslist[j+gap]) <= 0)
-                    break;
-                temp = g_fslist[j];
-                g_fslist[j] = g_fslist[j+gap];
-                g_fslist[j+gap] = temp;
+                sound(TRUE, 660, 4);
+                ret = ENMFIL;
             }
+            return ret;
         }
+        fs_flush();
     }
 
-    set_mouse_to_arrow();
-
     if ((ret == EFILNF) || (ret == ENMFIL))
-        return TRUE;
+    {
+        fs_dirs[nm_dirs++] = *dir;
+        fs_nxtname = end;
+        fs_nxtfile = dir->first + dir->count;
+    }
 
-    if (!IS_BIOS_ERROR(ret))    /* if BDOS error, issue message via form_error(): */
-        fm_error(-ret-31);      /* (need to convert to 'MS-DOS error code')       */
+    return ret;
+}
+
+
+/*
+ *  Make a particular path the active path.  This involves getting
+ *  the listing of its directory, from the cache or by reading it,
+ *  and selecting the folders & the files that match pspec for display.
+ *
+ *  Returns FALSE iff error occurred
+ */
+static WORD fs_active(BYTE *ppath, BYTE *pspec, WORD *pcount)
+{
+    LONG ret, i;
+    FSDIR *dir, newdir;
+    BYTE *p, path[LEN_ZPATH+1];
+    WORD count;
+
+    strlcpy(path, ppath, LEN_ZPATH+1);
+    p = fs_pspec(path, NULL);       /* 'path' is the directory */
+    *p = '\0';
 
-    return FALSE;
+    dir = fs_find(path);
+    if (!dir)
+    {
+        set_mouse_to_hourglass();
+        dir = &newdir;
+        ret = fs_load(path, pspec, dir);
+        set_mouse_to_arrow();
+
+        if ((ret != EFILNF) && (ret != ENMFIL))
+        {
+            if (!IS_BIOS_ERROR(ret))    /* if BDOS error, issue message via form_error(): */
+                fm_error(-ret-31);      /* (need to convert to 'MS-DOS error code')       */
+            return FALSE;
+        }
+    }
+
+    for (i = dir->first, count = 0; i < dir->first+dir->count; i++)
+    {
+        p = ad_fsnames + g_fslist[i];
+        if ((*p == 0x07) || wildcmp(pspec, p+1))
+            g_fsview[count++] = g_fslist[i];
+    }
+    *pcount = count;
+
+    return TRUE;
 }
 
 
@@ -285,7 +435,7 @@ static void fs_format(OBJECT *tree, WORD currtop, WORD count)
     {
         if (i < cnt)
         {
-            p = ad_fsnames + g_fslist[currtop+i];
+            p = ad_fsnames + g_fsview[currtop+i];
             fmt_str(p+1, name+1);       /* format file/folder name */
             name[0] = p[0];             /* copy file/folder indicator */
         }
@@ -550,19 +700,21 @@ WORD fs_input(BYTE *pipath, BYTE *pisel, WORD *pbutton, BYTE *pilabel)
         *pipath += dos_gdrv();
     }
 
-    /* get memory for the filename buffer
-     *  & for the array that points to it
+    /* get memory for the arrays that point to the filenames
+     *  & for the filename buffer (including the directory paths)
      */
     for (nm_files = MAX_NM_FILES; nm_files >= MIN_NM_FILES; nm_files /= 2)
     {
-        ad_fsnames = dos_alloc_anyram(nm_files*(LEN_FSNAME+sizeof(BYTE *)));
-        if (ad_fsnames)
+        g_fslist = dos_alloc_anyram(nm_files*(2*sizeof(LONG)+LEN_FSNAME) + NM_DIRS*(LEN_ZPATH+1));
+        if (g_fslist)
             break;
     }
-    if (!ad_fsnames)
+    if (!g_fslist)
         return FALSE;
 
-    g_fslist = (LONG *)(ad_fsnames+nm_files*LEN_FSNAME);
+    g_fsview = g_fslist + nm_files;
+    ad_fsnames = (BYTE *)(g_fsview + nm_files);
+    fs_flush();
 
     strcpy(locstr, pipath);
     strcpy(locold,locstr);
@@ -764,6 +916,7 @@ WORD fs_input(BYTE *pipath, BYTE *pisel, WORD *pbutton, BYTE *pilabel)
 
         if (newdrive)
         {
+            fs_flush();                         /* the disk may have changed */
             select_drive(tree, touchob-DRIVE_OFFSET,1);
             newdrive = FALSE;
             newlist = TRUE;
@@ -800,7 +953,7 @@ WORD fs_input(BYTE *pipath, BYTE *pisel, WORD *pbutton, BYTE *pilabel)
 
     /* return exit button */
     *pbutton = inf_what(tree, FSOK, FSCANCEL);
-    dos_free(ad_fsnames);
+    dos_free(g_fslist);
 
     return TRUE;
 }
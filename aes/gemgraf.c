@@ -41,7 +41,6 @@
 #define g_vsf_interior( x )       gsx_1code(S_FILL_STYLE, x)
 #define g_vsl_type( x )           gsx_1code(S_LINE_TYPE, x)
 #define g_vsf_style( x )          gsx_1code(S_FILL_INDEX, x)
-#define g_vsf_color( x )          gsx_1code(S_FILL_COLOR, x)
 #define g_vsl_udsty( x )          gsx_1code(ST_UD_LINE_STYLE, x)
 
 #define YRES_LIMIT  380     /* screens with yres less than this are considered */
@@ -94,6 +93,10 @@ GLOBAL GRECT    gl_rmenu;
 static WORD     gl_wsptschar;
 static WORD     gl_hsptschar;
 
+static WORD     gl_fcolor;      /* current fill colour */
+static WORD     gl_udsty;       /* current user-defined line style */
+static BOOL     gl_clipset;     /* the VDI clip matches gl_xclip etc. */
+
 
 /*
  *  Routine to set the clip rectangle.  If the w,h of the clip is 0,
@@ -101,7 +104,13 @@ static WORD     gl_hsptschar;
  */
 void gsx_sclip(const GRECT *pt)
 {
+    /* nothing to do if the VDI already has this clip */
+    if (gl_clipset && (pt->g_x == gl_xclip) && (pt->g_y == gl_yclip)
+     && (pt->g_w == gl_wclip) && (pt->g_h == gl_hclip))
+        return;
+
     r_get(pt, &gl_xclip, &gl_yclip, &gl_wclip, &gl_hclip);
+    gl_clipset = TRUE;
 
     if (gl_wclip && gl_hclip)
     {
@@ -116,6 +125,20 @@ void gsx_sclip(const GRECT *pt)
 }
 
 
+/*
+ *  Forget which clip rectangle, fill colour and line style the VDI has:
+ *  applications may change them through the AES's workstation handle
+ *  whenever they get control.  A fill colour of -1 and a line style of 0
+ *  are never set by the AES, so the next setting always reaches the VDI.
+ */
+void gsx_forgetclip(void)
+{
+    gl_clipset = FALSE;
+    gl_fcolor = -1;
+    gl_udsty = 0;
+}
+
+
 /*
  *  Routine to get the current clip setting
  */
@@ -148,6 +171,16 @@ WORD gsx_chkclip(GRECT *pt)
 }
 
 
+static void gsx_udsty(WORD style)
+{
+    if (style != gl_udsty)
+    {
+        g_vsl_udsty(style);
+        gl_udsty = style;
+    }
+}
+
+
 static void gsx_xline(WORD ptscount, WORD *ppoints)
 {
     static const WORD hztltbl[2] = { 0x5555, 0xaaaa };
@@ -166,11 +199,11 @@ static void gsx_xline(WORD ptscount, WORD *ppoints)
             linexy = (*ppoints < *(ppoints+2)) ? ppoints : ppoints + 2;
             st = hztltbl[*(linexy+1) & 1];
         }
-        g_vsl_udsty(st);
+        gsx_udsty(st);
         g_v_pline(2, ppoints);
         ppoints += 2;
     }
-    g_vsl_udsty(0xffff);
+    gsx_udsty(0xffff);
 }
 
 
@@ -209,6 +242,19 @@ void gsx_cline(UWORD x1, UWORD y1, UWORD x2, UWORD y2)
 /*
  *  Routine to set the text, writing mode, and color attributes
  */
+/*
+ *  Set the fill colour, unless it is already set
+ */
+void gsx_fcolor(WORD color)
+{
+    if (color != gl_fcolor)
+    {
+        gsx_1code(S_FILL_COLOR, color);
+        gl_fcolor = color;
+    }
+}
+
+
 void gsx_attr(UWORD text, UWORD mode, UWORD color)
 {
     WORD    tmp;
@@ -452,6 +498,17 @@ void gsx_start(void)
     g_vsl_type(7);
     g_vsl_width(1);
     g_vsl_udsty(0xffff);
+
+    /*
+     * the attributes that the gsx_ functions only set when they change,
+     * as gsx_wsopen() has just opened the workstation with them
+     */
+    gl_udsty = 0xffff;
+    gl_mode = MD_REPLACE;
+    gl_tcolor = gl_lcolor = gl_fcolor = BLACK;
+    gl_fis = FIS_SOLID;
+    gl_patt = 1;
+    gl_clipset = FALSE;
     r_set(&gl_rscreen, 0, 0, gl_width, gl_height);
     r_set(&gl_rfull, 0, gl_hbox, gl_width, (gl_height - gl_hbox));
     r_set(&gl_rzero, 0, 0, 0, 0);
@@ -591,7 +648,7 @@ void gr_rect(UWORD icolor, UWORD ipattern, GRECT *pt)
     else if (ipattern == IP_SOLID)
         fis = FIS_SOLID;
 
-    g_vsf_color(icolor);
+    gsx_fcolor(icolor);
     bb_fill(MD_REPLACE, fis, ipattern, pt->g_x, pt->g_y, pt->g_w, pt->g_h);
 }
 
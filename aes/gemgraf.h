@@ -15,6 +15,8 @@
 
 WORD gsx_chkclip(GRECT *pt);
 void gsx_cline(UWORD x1, UWORD y1, UWORD x2, UWORD y2);
+void gsx_fcolor(WORD color);
+void gsx_forgetclip(void);
 void gsx_xbox(GRECT *pt);
 void gsx_xcbox(GRECT *pt);
 void gsx_blt(void *saddr, UWORD sx, UWORD sy, UWORD swb,
@@ -49,6 +49,7 @@
 #include "gemgraf.h"
 #include "gemevlib.h"
 #include "gemwmlib.h"
+#include "gemwrect.h"
 #include "gemfslib.h"
 #include "gemoblib.h"
 #include "gemsclib.h"
@@ -110,12 +111,16 @@ GLOBAL MFORM    gl_mouse;
 GLOBAL BYTE     gl_logdrv;
 
 GLOBAL AESPD    *rlr, *drl, *nrl;
-GLOBAL EVB      *eul, *dlr, *zlr;
+GLOBAL EVB      *eul, *zlr;
+GLOBAL EVB      *dlheap[NUM_PDS];       /* pending delays, see adelay() */
+GLOBAL WORD     dlcnt;
 
 GLOBAL BYTE     indisp;
 
 GLOBAL WORD     fpt, fph, fpcnt;                /* forkq tail, head,    */
                                                 /*   count              */
+GLOBAL UWORD    fpovf;                          /* forks dropped, ring full */
+GLOBAL UWORD    kqovf;                          /* keys dropped, queue full */
 GLOBAL SPB      wind_spb;
 GLOBAL WORD     curpid;
 
@@ -643,6 +648,9 @@ void run_accs_and_desktop(void)
      * that the inner pair clobbered it with (issue #46).
      */
     gl_ticktime = gsx_tick(tikaddr, &tiksav);
+#if CONF_WITH_TICKLESS_IDLE
+    tickless_start();               /* the tick is now hooked as it should be */
+#endif
 
     /* set initial click rate: must do this after setting gl_ticktime */
     ev_dclick(3, TRUE);
@@ -752,8 +760,10 @@ void gem_main(void)
 
     /* initialize list and unused lists   */
     nrl = drl = NULL;
-    dlr = zlr = NULL;
+    zlr = NULL;
+    dlcnt = 0;
     fph = fpt = fpcnt = 0;
+    fpovf = kqovf = 0;
 
     /* init initial process */
     for(i=totpds-1; i>=0; i--)
@@ -769,8 +779,9 @@ void gem_main(void)
             rlr->p_uda = &D.g_acc[i-2].a_uda;
             rlr->p_cda = &D.g_acc[i-2].a_cda;
         }
-        rlr->p_qaddr = rlr->p_queue;
+        rlr->p_qhead = 0;
         rlr->p_qindex = 0;
+        rlr->p_qread = 0;
         memset(rlr->p_name, ' ', AP_NAMELEN);
         rlr->p_appdir[0] = '\0'; /* by default, no application directory */
         /* if not rlr then initialize his stack pointer */
@@ -826,4 +837,5 @@ void gem_main(void)
 
     if (D.g_acc)
         dos_free(D.g_acc);
+    or_end();
 }
@@ -238,6 +238,8 @@ static void nq(UWORD ch, CQUEUE *qptr)
             qptr->c_rear = 0;
         qptr->c_cnt++;
     }
+    else
+        kqovf++;
 }
 
 
@@ -474,55 +476,133 @@ void akbin(EVB *e)
 }
 
 
-void adelay(EVB *e, LONG c)
+/*
+ * Pending MU_TIMER events are kept in dlheap[], a binary min-heap on
+ * their deadline: adding or cancelling one costs O(log n), and the
+ * earliest deadline, which the tick countdown in CMP_TICK runs to, is
+ * always dlheap[0].  A deadline is held in e_parm, in a time base that
+ * only advances while a delay is pending: dl_base plus the ticks the
+ * tick handler has counted in NUM_TICK since the last dl_arm().
+ */
+static ULONG dl_base;
+
+#define DL_BEFORE(a, b)     ((LONG)((ULONG)(a)->e_parm - (ULONG)(b)->e_parm) < 0)
+
+static void dl_place(EVB *e, WORD i)
 {
-    EVB *p, *q;
+    dlheap[i] = e;
+    e->e_slot = i;
+}
 
-    if (c == 0L)
-        c = 1L;
+/*
+ * put e in slot i, then move it up or down until the heap is in order
+ */
+static void dl_sift(EVB *e, WORD i)
+{
+    WORD parent, child;
 
-    disable_interrupts();
-    if (CMP_TICK)
+    while (i > 0)
     {
-        /*
-         * if already counting down, then reset CMP_TICK to the lower
-         * number, but let NUM_TICK grow from its accumulated value
-         */
-        if (c <= CMP_TICK)
-            CMP_TICK = c;
-    }
-    else
-    {
-        /*
-         * if we aren't currently counting down for someone else,
-         * then start ticking
-         */
-        CMP_TICK = c;
-        NUM_TICK = 0L;      /* start NUM_TICK out at zero */
+        parent = (i - 1) / 2;
+        if (!DL_BEFORE(e, dlheap[parent]))
+            break;
+        dl_place(dlheap[parent], i);
+        i = parent;
     }
 
-    e->e_flag |= EVDELAY;
-    q = (EVB *) ((BYTE *) &dlr - offsetof(EVB, e_link));
-    for (p = dlr; p; p = (q = p) -> e_link)
+    while ((child = 2 * i + 1) < dlcnt)
     {
-        if (c <= p->e_parm)
+        if ((child + 1 < dlcnt) && DL_BEFORE(dlheap[child+1], dlheap[child]))
+            child++;
+        if (!DL_BEFORE(dlheap[child], e))
             break;
-        c -= p->e_parm;
+        dl_place(dlheap[child], i);
+        i = child;
     }
-    e->e_pred = q;
-    q->e_link = e;
-    e->e_parm = c;
-    e->e_link = p;
-    if (p)
+
+    dl_place(e, i);
+}
+
+static void dl_remove(EVB *e)
+{
+    EVB *last = dlheap[--dlcnt];
+
+    if (last != e)
+        dl_sift(last, e->e_slot);
+}
+
+/*
+ * restart the tick countdown for the earliest deadline
+ */
+static void dl_arm(void)
+{
+    LONG c = 0L;
+
+    disable_interrupts();
+    dl_base += NUM_TICK;
+    NUM_TICK = 0L;
+    if (dlcnt)
     {
-        c = p->e_parm - c;
-        p->e_pred = e;
-        p->e_parm = c;
+        c = (LONG)((ULONG)dlheap[0]->e_parm - dl_base);
+        if (c < 1L)
+            c = 1L;
     }
+    CMP_TICK = c;
     enable_interrupts();
 }
 
 
+void adelay(EVB *e, LONG c)
+{
+    if (c == 0L)
+        c = 1L;
+
+    e->e_flag |= EVDELAY;
+    disable_interrupts();
+    e->e_parm = dl_base + NUM_TICK + c;
+    enable_interrupts();
+
+    dl_sift(e, dlcnt++);
+    if (e->e_slot == 0)         /* new earliest deadline */
+        dl_arm();
+}
+
+
+void dlcancel(EVB *e)
+{
+    WORD slot = e->e_slot;
+
+    dl_remove(e);
+    if (slot == 0)
+        dl_arm();
+}
+
+
+void tchange(LONG c)            /* c=number of ticks that have gone by  */
+{
+    EVB *e;
+    ULONG now;
+
+    /*
+     * the time base says how long it has been, c is only kept for
+     * appl_trecord()
+     */
+    disable_interrupts();
+    now = dl_base + NUM_TICK;
+    enable_interrupts();
+
+    /* wake up the pd's that have waited long enough */
+    while (dlcnt && ((LONG)(now - (ULONG)dlheap[0]->e_parm) >= 0))
+    {
+        e = dlheap[0];
+        dl_remove(e);
+        azombie(e, 0);
+    }
+
+    dl_arm();
+}
+
+
 void abutton(EVB *e, LONG p)
 {
     WORD bclicks;
@@ -42,6 +42,8 @@ void mchange(LONG fdata);
 
 void akbin(EVB *e);
 void adelay(EVB *e, LONG c);
+void dlcancel(EVB *e);
+void tchange(LONG c);
 void abutton(EVB *e, LONG p);
 void amouse(EVB *e, LONG pmo);
 
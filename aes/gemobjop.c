@@ -82,6 +82,7 @@ void everyobj(OBJECT *tree, WORD this, WORD last, EVERYOBJ_CALLBACK routine,
     WORD    depth;
     WORD    x[MAX_DEPTH+2], y[MAX_DEPTH+2];
     OBJECT  *obj;
+    BOOL    kids;
 
     x[0] = startx;
     y[0] = starty;
@@ -99,13 +100,13 @@ child:
     obj = tree + this;
     x[depth] = x[depth-1] + obj->ob_x;
     y[depth] = y[depth-1] + obj->ob_y;
-    (*routine)(tree, this, x[depth], y[depth]);
+    kids = (*routine)(tree, this, x[depth], y[depth]);
 
     /* if this guy has kids then do them */
     tmp1 = obj->ob_head;
     if (tmp1 != NIL)
     {
-        if (!(obj->ob_flags & HIDETREE) && (depth <= maxdep))
+        if (kids && !(obj->ob_flags & HIDETREE) && (depth <= maxdep))
         {
             depth++;
             this = tmp1;
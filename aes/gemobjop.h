@@ -10,7 +10,8 @@
 #ifndef GEMOBJOP_H
 #define GEMOBJOP_H
 
-typedef void (*EVERYOBJ_CALLBACK)(OBJECT *tree, WORD obj, WORD sx, WORD sy);
+/* returns FALSE if the children of obj are to be skipped */
+typedef BOOL (*EVERYOBJ_CALLBACK)(OBJECT *tree, WORD obj, WORD sx, WORD sy);
 
 BYTE ob_sst(OBJECT *tree, WORD obj, OBSPEC *pspec, WORD *pstate, WORD *ptype,
             WORD *pflags, GRECT *pt, WORD *pth);
@@ -33,13 +33,11 @@
 #include "optimopt.h"
 #include "rectfunc.h"
 #include "gemoblib.h"
+#include "gemrslib.h"
 
 #include "string.h"
 #include "kprint.h"
 
-                                                /* in GSXBIND.C         */
-#define g_vsf_color( x )          gsx_1code(S_FILL_COLOR, x)
-
 
 /*
  *  Routine to find the x,y offset of a particular object relative
@@ -213,9 +211,62 @@ static BOOL is_dashes(const WORD *s, WORD len)
 
 
 /*
- *  Routine to draw an object from an object tree.
+ *  Return TRUE if the children of obj (whose rectangle is t) cannot
+ *  reach the clip rectangle, so that ob_draw() need not visit them.
+ *  Like ob_find(), this relies on a parent containing its children; it
+ *  is only assumed for leaf children other than icons, images and
+ *  user-defined objects.  The parent is widened by the largest extent
+ *  that one of them may draw outside itself, as just_draw() reckons it.
+ */
+static BOOL kids_clipped(OBJECT *tree, WORD obj, const GRECT *t)
+{
+    OBJECT  *kid;
+    OBSPEC  spec;
+    GRECT   c;
+    WORD    this, state, obtype, flags, th, ext, margin;
+
+    margin = 0;
+    for (this = tree[obj].ob_head; (this != obj) && (this != NIL); this = kid->ob_next)
+    {
+        kid = tree + this;
+        if (kid->ob_head != NIL)
+            return FALSE;
+        switch(kid->ob_type & 0x00ff)
+        {
+        case G_IMAGE:
+        case G_USERDEF:
+        case G_ICON:
+#if CONF_WITH_COLOUR_ICONS
+        case G_CICON:
+#endif
+            return FALSE;
+        }
+        if ((kid->ob_x < 0) || (kid->ob_y < 0)
+         || (kid->ob_x + kid->ob_width > t->g_w)
+         || (kid->ob_y + kid->ob_height > t->g_h))
+            return FALSE;
+
+        /* outside thickness, shadow & outline */
+        ob_sst(tree, this, &spec, &state, &obtype, &flags, &c, &th);
+        ext = (th < 0) ? (-3 * th) : (3 * th);
+        if ((state & OUTLINED) && (ext < 3))
+            ext = 3;
+        if (ext > margin)
+            margin = ext;
+    }
+
+    rc_copy(t, &c);
+    gr_inside(&c, -margin);
+
+    return !gsx_chkclip(&c);
+}
+
+
+/*
+ *  Routine to draw an object from an object tree.  Returns FALSE if
+ *  its children need not be drawn either.
  */
-static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
+static BOOL just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 {
     WORD bcol, tcol, ipat, icol, tmode, th;
     WORD state, obtype, len, flags;
@@ -230,8 +281,10 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 
     ch = ob_sst(tree, obj, &spec, &state, &obtype, &flags, &t, &th);
 
-    if ((flags & HIDETREE) || (spec.index == -1L))
-        return;
+    if (flags & HIDETREE)
+        return FALSE;
+    if (spec.index == -1L)
+        return TRUE;
 
     t.g_x = sx;
     t.g_y = sy;
@@ -249,7 +302,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
             gr_inside(&c, ((th < 0) ? (3 * th) : (-3 * th)) );
 
         if (!(gsx_chkclip(&c)))
-            return;
+            return !kids_clipped(tree, obj, &t);
     }
 
     /*
@@ -354,7 +407,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 #if CONF_WITH_COLOUR_ICONS
         case G_CICON:   /* a CICONBLK starts with an ICONBLK */
             if (obtype == G_CICON)
-                cicon = spec.ciconblk->mainlist;
+                cicon = rs_cicon(spec.ciconblk);
 #endif
             ib = *(spec.iconblk);
             ib.ib_xicon += t.g_x;
@@ -421,7 +474,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 
         if ((state & SHADOWED) && th)
         {
-            g_vsf_color(bcol);
+            gsx_fcolor(bcol);
             bb_fill(MD_REPLACE, FIS_SOLID, 0, t.g_x, t.g_y+t.g_h+th,
                     t.g_w + th, 2*th);
             bb_fill(MD_REPLACE, FIS_SOLID, 0, t.g_x+t.g_w+th, t.g_y,
@@ -444,7 +497,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 
         if (state & DISABLED)
         {
-            g_vsf_color(WHITE);
+            gsx_fcolor(WHITE);
             bb_fill(MD_TRANS, FIS_PATTERN, IP_4PATT, t.g_x, t.g_y,
                     t.g_w, t.g_h);
         }
@@ -454,6 +507,8 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
             bb_fill(MD_XOR, FIS_SOLID, IP_SOLID, t.g_x,t.g_y, t.g_w, t.g_h);
         }
     }
+
+    return TRUE;
 } /* just_draw */
 
 
@@ -3,7 +3,7 @@
 
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2016 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -30,60 +30,171 @@
 
 
 
-static void doq(WORD donq, AESPD *p, QPB *m)
+/*
+ * Each process's message pipe is a ring buffer of QUEUE_SIZE bytes:
+ * p_qindex bytes starting at offset p_qhead.  Besides that, the process
+ * remembers where the pending WM_REDRAW for each window and the pending
+ * WM_ARROWED sit in the pipe, as positions in the stream of bytes ever
+ * written (p_qread is the position of the oldest byte), so that merging
+ * a new message into one of them needs no scan of the pipe.
+ */
+
+/* offset in p_queue of the byte delta bytes past the oldest one */
+static WORD q_offset(AESPD *p, WORD delta)
 {
-    WORD n, index;
-    WORD *om, *nm;
+    WORD index = p->p_qhead + delta;
 
-    n = m->qpb_cnt;
-    if (donq)
+    if (index >= QUEUE_SIZE)
+        index -= QUEUE_SIZE;
+
+    return index;
+}
+
+static void q_copyin(AESPD *p, WORD index, const BYTE *src, WORD n)
+{
+    WORD first = QUEUE_SIZE - index;
+
+    if (n <= first)
+        memcpy(p->p_queue+index, src, n);
+    else
+    {
+        memcpy(p->p_queue+index, src, first);
+        memcpy(p->p_queue, src+first, n-first);
+    }
+}
+
+static void q_copyout(AESPD *p, WORD index, BYTE *dst, WORD n)
+{
+    WORD first = QUEUE_SIZE - index;
+
+    if (n <= first)
+        memcpy(dst, p->p_queue+index, n);
+    else
     {
-        memcpy(p->p_qaddr+p->p_qindex, (BYTE *)m->qpb_buf, n);
-        /*
-         * if it's a redraw msg, try to find a matching msg and
-         * union the redraw rectangles together
-         */
-        nm = (WORD *) &p->p_queue[p->p_qindex];
-        if ((nm[0] == WM_REDRAW) || (nm[0] == WM_ARROWED) || (nm[0] == WM_HSLID) || (nm[0] == WM_VSLID))
+        memcpy(dst, p->p_queue+index, first);
+        memcpy(dst+first, p->p_queue, n-first);
+    }
+}
+
+/*
+ * Look for a whole, still unread message of the given type (and window
+ * handle, unless it is -1) at stream position pos.  If it is there, copy
+ * it to om and return its offset in p_queue; otherwise return -1.
+ */
+static WORD q_find(AESPD *p, ULONG pos, WORD type, WORD handle, WORD *om)
+{
+    ULONG delta = pos - p->p_qread;
+    WORD index;
+
+    if ((p->p_qindex < 16) || (delta > (ULONG)(p->p_qindex - 16)))
+        return -1;
+
+    index = q_offset(p, (WORD)delta);
+    q_copyout(p, index, (BYTE *)om, 16);
+    if ((om[0] != type) || ((handle >= 0) && (om[3] != handle)))
+        return -1;
+
+    return index;
+}
+
+/*
+ * Read n bytes from the front of p's pipe, which must hold that many
+ */
+void q_read(AESPD *p, BYTE *buf, WORD n)
+{
+    q_copyout(p, p->p_qhead, buf, n);
+    p->p_qindex -= n;
+    p->p_qread += n;
+    /* an empty pipe starts over, so that messages rarely wrap */
+    p->p_qhead = p->p_qindex ? q_offset(p, n) : 0;
+}
+
+static void q_write(AESPD *p, const BYTE *buf, WORD n)
+{
+    const WORD *nm = (const WORD *)buf;
+    ULONG pos = p->p_qread + p->p_qindex;
+    WORD om[8];
+    WORD index, wh;
+
+    if (n == 16)
+    {
+        wh = nm[3];
+        switch(nm[0])
         {
-            index = 0;
-            while ((index < p->p_qindex) && n)
+        case WM_REDRAW:
+            /* if a redraw for the same window is pending, union the rectangles */
+            if ((wh < 0) || (wh >= NUM_WIN))
+                break;
+            index = q_find(p, p->p_qredraw[wh], WM_REDRAW, wh, om);
+            if (index < 0)
+            {
+                p->p_qredraw[wh] = pos;
+                break;
+            }
+            rc_union((const GRECT *)&nm[4], (GRECT *)&om[4]);   /* FIXME: Ugly pointer typecasting */
+            q_copyin(p, index, (BYTE *)om, 16);
+            return;
+        case WM_ARROWED:
+        case WM_HSLID:
+        case WM_VSLID:
+            /* if an arrow message is pending, the new message replaces it */
+            index = q_find(p, p->p_qarrow, WM_ARROWED, -1, om);
+            if (index >= 0)
             {
-                om = (WORD *) &p->p_queue[index];
-                /* if redraw and same handle then union */
-                if ((om[0] == WM_REDRAW) && (nm[3] == om[3]))
-                {
-                    rc_union((GRECT *)&nm[4], (GRECT *)&om[4]);  /* FIXME: Ugly pointer typecasting */
-                    n = 0;
-                }
-                else
-                {
-                    /*
-                     * if another arrow command then copy over with new msg
-                     * else add in length and get next msg
-                     */
-                    if (om[0] == WM_ARROWED)
-                    {
-                        memcpy(om, nm, 16);
-                        n = 0;
-                    }
-                    else
-                        index += ((UWORD)om[2] != 0xFFFF) ? (om[2] + 16) : 16;
-                }
+                q_copyin(p, index, buf, 16);
+                return;
             }
+            if (nm[0] == WM_ARROWED)
+                p->p_qarrow = pos;
+            break;
         }
-        p->p_qindex += n;
     }
-    else
+
+    q_copyin(p, q_offset(p, p->p_qindex), buf, n);
+    p->p_qindex += n;
+}
+
+
+/*
+ * Discard whatever is in p's pipe.  As after a read through aqueue(),
+ * writers that were blocked on a full pipe then get their messages in,
+ * as long as they fit.
+ */
+void q_flush(AESPD *p)
+{
+    EVB     *e;
+    QPB     *m;
+
+    p->p_qread += p->p_qindex;
+    p->p_qindex = 0;
+    p->p_qhead = 0;
+
+    while ((e = p->p_qnq) != NULL)
     {
-        memcpy((BYTE *)m->qpb_buf, p->p_qaddr, n);
-        p->p_qindex -= n;
-        if (p->p_qindex)
-            memcpy(p->p_qaddr, p->p_qaddr+n, p->p_qindex);
+        m = (QPB *)e->e_parm;
+        if (m->qpb_cnt > QUEUE_SIZE-p->p_qindex)
+            break;
+
+        e->e_flag |= NOCANCEL;
+        p->p_qnq = e->e_link;
+        if (e->e_link)
+            e->e_link->e_pred = e->e_pred;
+
+        q_write(p, (const BYTE *)m->qpb_buf, m->qpb_cnt);
+        azombie(e, 0);
     }
 }
 
 
+static void doq(WORD donq, AESPD *p, QPB *m)
+{
+    if (donq)
+        q_write(p, (const BYTE *)m->qpb_buf, m->qpb_cnt);
+    else
+        q_read(p, (BYTE *)m->qpb_buf, m->qpb_cnt);
+}
+
+
 void aqueue(WORD isqwrite, EVB *e, LONG lm)
 {
     AESPD   *p;
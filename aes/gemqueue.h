@@ -10,6 +10,8 @@
 #ifndef GEMQUEUE_H
 #define GEMQUEUE_H
 
+void q_read(AESPD *p, BYTE *buf, WORD n);
+void q_flush(AESPD *p);
 void aqueue(WORD isqwrite, EVB *e, LONG lm);
 
 #endif
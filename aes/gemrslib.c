@@ -182,6 +182,26 @@ void *get_addr(UWORD rstype, UWORD rsindex)
 
 
 #if CONF_WITH_COLOUR_ICONS
+#if CONF_WITH_LAZY_CICONS
+/*
+ * num_planes of a CICON whose device-dependent form hasn't been built yet,
+ * and of one for which building it failed
+ */
+#define CICON_PENDING   (-1)
+#define CICON_FAILED    (-2)
+#endif
+
+/*
+ * the standard-format data of a CICON, kept in front of the buffer for
+ * its device-dependent form (see transform_all_cicons())
+ */
+typedef struct {
+    WORD *col_data;
+    WORD *sel_data;
+    WORD num_planes;
+    WORD w, h;
+} CICON_SRC;
+
 /*
  * returns pointer to a CICON that best matches the current resolution
  *
@@ -327,72 +347,109 @@ static void pack_planes(const WORD *data, void *pixels, WORD planes, WORD w, WOR
 }
 
 /*
- *  pack_cicon: convert the selected CICON's standard-format colour data
- *  to the packed-truecolor layout.  The normal and (optional) selected
- *  buffers use the active pixel format and are packed back-to-back in a
- *  single allocation so
- *  free_cicon_buffers() (which frees only cicon->col_data) still works.
+ *  pack_cicon: convert standard-format colour data to the packed-truecolor
+ *  layout.  The normal and (optional) selected buffers use the active pixel
+ *  format and lie back-to-back in the buffer allocated at load time.
  */
-static BOOL pack_cicon(CICON *cicon, WORD w, WORD h)
+static void pack_cicon(CICON *cicon, const CICON_SRC *src)
 {
-    LONG pixels = (LONG)w * h;
-    void *packed;
-    WORD pixel_size;
+    WORD pixel_size = vdi_truecolor_pixel_size();
 
-    pixel_size = vdi_truecolor_pixel_size();
-    packed = dos_alloc_anyram(pixels * (cicon->sel_data ? 2 : 1) * pixel_size);
-    if (!packed)
-        return FALSE;
+    pack_planes(src->col_data, cicon->col_data, src->num_planes, src->w, src->h, pixel_size);
+    if (src->sel_data)
+        pack_planes(src->sel_data, cicon->sel_data, src->num_planes, src->w, src->h, pixel_size);
+
+    cicon->num_planes = 1;
+}
+#endif
+
+/*
+ * expand & transform the standard-format colour data of a CICON into the
+ * device-dependent buffers allocated at load time
+ *
+ * returns FALSE if the temporary expansion buffer can't be allocated
+ */
+static BOOL convert_cicon(CICON *cicon, const CICON_SRC *src)
+{
+    WORD *expandbuf = NULL, *data;
+    LONG data_size;
+
+#if CONF_WITH_VDI_BACKEND_TRUECOLOR
+    /*
+     * Packed-truecolor screen: there are no bitplanes to expand to.
+     * Convert the standard-format colour planes straight to one
+     * active-format pixel per bit (w*h UWORDs for RGB565, ULONGs for
+     * XRGB8888, num_planes=1).  Skipping
+     * expand_cicondata()/transform_cicon() here is what avoids the
+     * 16-plane interleaved form that setup_info() cannot interpret.
+     * Pixels whose colour code is 0 keep their own palette colour
+     * (the icon background -- the mask blit in gr_gicon() is what
+     * paints the object's background over the shape); this is the
+     * deliberate truecolor look, see the design doc.
+     */
+    if (vdi_truecolor_screen())
+    {
+        pack_cicon(cicon, src);
+        return TRUE;
+    }
+#endif
+    data_size = (LONG)(src->w/8*gl_nplanes) * src->h;
 
-    pack_planes(cicon->col_data, packed, cicon->num_planes, w, h, pixel_size);
-    cicon->col_data = (WORD *)packed;
+    /* if we need to expand the icon, we need a temp buffer */
+    if (src->num_planes != gl_nplanes)
+    {
+        expandbuf = dos_alloc_anyram(data_size);
+        if (!expandbuf)
+            return FALSE;
+    }
 
-    if (cicon->sel_data)
+    /* handle standard icon */
+    data = src->col_data;
+    if (expandbuf)
     {
-        if (pixel_size == sizeof(UWORD))
-        {
-            UWORD *selbuf = (UWORD *)packed + pixels;
+        expand_cicondata(data, expandbuf, cicon->col_mask, src->w, src->h, src->num_planes, gl_nplanes);
+        data = expandbuf;
+    }
+    transform_cicon(data, cicon->col_data, src->w, src->h, gl_nplanes);
 
-            pack_planes(cicon->sel_data, selbuf, cicon->num_planes, w, h, pixel_size);
-            cicon->sel_data = (WORD *)selbuf;
-        }
-        else
+    /* handle 'selected' icon (if present) */
+    if (src->sel_data)
+    {
+        data = src->sel_data;
+        if (expandbuf)
         {
-            ULONG *selbuf = (ULONG *)packed + pixels;
-
-            pack_planes(cicon->sel_data, selbuf, cicon->num_planes, w, h, pixel_size);
-            cicon->sel_data = (WORD *)selbuf;
+            expand_cicondata(data, expandbuf, cicon->sel_mask, src->w, src->h, src->num_planes, gl_nplanes);
+            data = expandbuf;
         }
+        transform_cicon(data, cicon->sel_data, src->w, src->h, gl_nplanes);
     }
 
-    cicon->num_planes = 1;
+    if (expandbuf)
+        dos_free(expandbuf);
+
+    cicon->num_planes = gl_nplanes;     /* neatness only */
     return TRUE;
 }
-#endif
 
-/*
- * initialise the colour icon stuff
- *
- * this includes:
- *  . filling in the CICONBLK pointer table
- *  . for each CICONBLK:
- *      . fixing up all of the internal data/mask/text pointers
- *      . determining the appropriate icon for the current resolution
- *      . expanding the icon if necessary
- *      . converting the icon to device-dependent form
- */
 /*
  * for each CICONBLK in the resource, select the CICON with the number of
- * planes that best matches the current resolution.  then expand the icon
- * if necessary, and transform it from standard to device-dependent format
+ * planes that best matches the current resolution, allocate the buffer
+ * for its device-dependent form, and transform it.
+ *
+ * with CONF_WITH_LAZY_CICONS, the transformation itself is left to the
+ * first rs_cicon() for the icon, so that icons which are never drawn cost
+ * nothing but their buffer.  Until then, the CICON's num_planes is
+ * CICON_PENDING and the standard-format data is described by the
+ * CICON_SRC in front of the buffer.  The buffer is allocated here, rather
+ * than at draw time, because it must belong to the process that owns the
+ * resource: objects may be drawn while another process is current.
  */
 void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
 {
     CICONBLK *ciconblk;
     CICON *cicon;
-    WORD *colbuf, *selbuf, *expandbuf, *src;
-    LONG data_size, n;
-    BOOL expand;
+    CICON_SRC *src;
+    LONG data_size;
     WORD i, w, h;
 
     for (i = 0; i < num_cicons; i++)
@@ -405,82 +462,69 @@ void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
         w = ciconblk->monoblk.ib_wicon;
         h = ciconblk->monoblk.ib_hicon;
 #if CONF_WITH_VDI_BACKEND_TRUECOLOR
-        /*
-         * Packed-truecolor screen: there are no bitplanes to expand to.
-         * Convert the standard-format colour planes straight to one
-         * active-format pixel per bit (w*h UWORDs for RGB565, ULONGs for
-         * XRGB8888, num_planes=1).  Skipping
-         * expand_cicondata()/transform_cicon() here is what avoids the
-         * 16-plane interleaved form that setup_info() cannot interpret.
-         * Pixels whose colour code is 0 keep their own palette colour
-         * (the icon background -- the mask blit in gr_gicon() is what
-         * paints the object's background over the shape); this is the
-         * deliberate truecolor look, see the design doc.
-         */
         if (vdi_truecolor_screen())
-        {
-            cicon->next_res = NULL;
-            if (!pack_cicon(cicon, w, h))
-                ciconblk->mainlist = NULL;  /* no colour for this icon */
-            continue;
-        }
+            data_size = (LONG)w * h * vdi_truecolor_pixel_size();
+        else
 #endif
         data_size = (LONG)(w/8*gl_nplanes) * h;
-        expand = (cicon->num_planes != gl_nplanes); /* boolean */
-
-        /* if we need to expand the icon, we need a temp buffer */
-        expandbuf = NULL;
-        if (expand)
-        {
-            expandbuf = dos_alloc_anyram(data_size);
-            if (!expandbuf)
-            {
-                ciconblk->mainlist = NULL;  /* no colour for this icon */
-                continue;
-            }
-        }
 
         /* we always allocate a data buffer so we avoid transform-in-place */
-        n = cicon->sel_data ? 2*data_size : data_size;
-        colbuf = dos_alloc_anyram(n);
-        if (!colbuf)
+        src = dos_alloc_anyram(sizeof(CICON_SRC) + (cicon->sel_data ? 2*data_size : data_size));
+        if (!src)
         {
-            if (expandbuf)
-                dos_free(expandbuf);
-            ciconblk->mainlist = NULL;      /* no colour for this icon */
+            ciconblk->mainlist = NULL;  /* no colour for this icon */
             continue;
         }
 
-        /* handle standard icon */
-        src = cicon->col_data;
-        if (expand)
-        {
-            expand_cicondata(src, expandbuf, cicon->col_mask, w, h, cicon->num_planes, gl_nplanes);
-            src = expandbuf;
-        }
-        transform_cicon(src, colbuf, w, h, gl_nplanes);
-        cicon->col_data = colbuf;
+        src->col_data = cicon->col_data;
+        src->sel_data = cicon->sel_data;
+        src->num_planes = cicon->num_planes;
+        src->w = w;
+        src->h = h;
 
-        /* handle 'selected' icon (if present) */
+        cicon->col_data = (WORD *)(src + 1);
         if (cicon->sel_data)
+            cicon->sel_data = (WORD *)((UBYTE *)cicon->col_data + data_size);
+        cicon->next_res = NULL;
+#if CONF_WITH_LAZY_CICONS
+        cicon->num_planes = CICON_PENDING;
+#else
+        if (!convert_cicon(cicon, src))
         {
-            selbuf = colbuf + data_size/sizeof(WORD);
-            src = cicon->sel_data;
-            if (expand)
-            {
-                expand_cicondata(src, expandbuf, cicon->sel_mask, w, h, cicon->num_planes, gl_nplanes);
-                src = expandbuf;
-            }
-            transform_cicon(src, selbuf, w, h, gl_nplanes);
-            cicon->sel_data = selbuf;
+            cicon->col_data = src->col_data;
+            cicon->sel_data = src->sel_data;
+            dos_free(src);
+            ciconblk->mainlist = NULL;  /* no colour for this icon */
         }
+#endif
+    }
+}
 
-        cicon->num_planes = gl_nplanes;     /* neatness only */
-        cicon->next_res = NULL;
+/*
+ * return the colour icon to draw for a CICONBLK, transforming it first
+ * if this is the first time it is drawn
+ *
+ * returns NULL if there is no colour icon, or it couldn't be transformed:
+ * the caller then draws the monochrome icon
+ */
+CICON *rs_cicon(CICONBLK *ciconblk)
+{
+    CICON *cicon = ciconblk->mainlist;
 
-        if (expandbuf)
-            dos_free(expandbuf);
-    }
+#if CONF_WITH_LAZY_CICONS
+    if (!cicon)
+        return NULL;
+
+    /* a failure is final: don't retry it on every redraw */
+    if (cicon->num_planes == CICON_PENDING)
+        if (!convert_cicon(cicon, (CICON_SRC *)cicon->col_data - 1))
+            cicon->num_planes = CICON_FAILED;
+
+    if (cicon->num_planes == CICON_FAILED)
+        return NULL;
+#endif
+
+    return cicon;
 }
 
 /*
@@ -535,7 +579,7 @@ static WORD free_cicon_buffers(RSHDR *hdr)
     {
         cicon = (*p)->mainlist;
         if (cicon)
-            if (dos_free(cicon->col_data))
+            if (dos_free((CICON_SRC *)cicon->col_data - 1))
                 rc = -1;
     }
 
@@ -35,6 +35,9 @@ WORD rs_gaddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void **rsaddr);
 WORD rs_saddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void *rsaddr);
 void rs_fixit(AESGLOBAL *pglobal);
 WORD rs_load(AESGLOBAL *pglobal, BYTE *rsfname);
+#if CONF_WITH_COLOUR_ICONS
+CICON *rs_cicon(CICONBLK *ciconblk);
+#endif
 #if !CONF_WITH_LEGACY_RSC_LOAD
 OBJECT *rs_loadmem(AESGLOBAL *pglobal, const void *rsmem, LONG size);
 #endif
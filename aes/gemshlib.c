@@ -35,6 +35,7 @@
 
 #include "gemdosif.h"
 #include "gemdos.h"
+#include "../bios/tosvars.h"
 #include "gemgraf.h"
 #include "gemgsxif.h"
 #include "gemoblib.h"
@@ -46,6 +47,7 @@
 #include "gemrslib.h"
 #include "gemaplib.h"
 #include "gemmnlib.h"
+#include "gemqueue.h"
 #include "gemasm.h"
 #include "optimopt.h"
 
@@ -74,6 +76,27 @@ GLOBAL BYTE *ad_stail;
 
 GLOBAL WORD gl_shgem;
 
+/*
+ * Results of recent searches of the AES path by sh_find().  A file that
+ * was found is looked for again where it was found, which is a single
+ * Fsfirst() instead of one per path entry; a file that was not found is
+ * reported missing without searching.  Entries expire after a while, so
+ * that files added to the path directories are seen, and they are all
+ * forgotten when the AES path differs from the one they were found with.
+ */
+#define NUM_SHPATH      4
+#define SHPATH_HIT      (30*200L)       /* lifetime of a hit, in 200Hz ticks */
+#define SHPATH_MISS     (2*200L)        /* lifetime of a miss */
+
+typedef struct {
+    BYTE name[LEN_ZFNAME];              /* name searched for, "" => unused */
+    BYTE path[LEN_ZPATH];               /* where it was found, "" => not found */
+    LONG stamp;                         /* hz_200 when stored */
+} SHPATH;
+
+static SHPATH sh_pathcache[NUM_SHPATH];
+static BYTE sh_pathenv[WORKAREASIZE];   /* the AES path of the entries */
+
 /*
  *  Resolution settings:
  *      gl_changerez: 0=no change, 1=change ST resolution, 2=change Falcon resolution
@@ -374,6 +397,84 @@ static BYTE *sh_path(BYTE *src, BYTE *dest, BYTE *pname)
 }
 
 
+/*
+ *  Check the AES path against the one sh_pathcache[] was filled with,
+ *  forgetting all the entries if it differs.  Returns FALSE if the path
+ *  is too long to be remembered: the cache is not used then.
+ */
+static BOOL sh_pathcheck(const BYTE *path)
+{
+    SHPATH *e;
+
+    if (strcmp(sh_pathenv, path) == 0)
+        return TRUE;
+
+    for (e = sh_pathcache; e < sh_pathcache+NUM_SHPATH; e++)
+        e->name[0] = '\0';
+
+    if (strlen(path) >= sizeof(sh_pathenv))
+    {
+        sh_pathenv[0] = '\0';
+        return FALSE;
+    }
+    strcpy(sh_pathenv, path);
+
+    return TRUE;
+}
+
+
+/*
+ *  Return the unexpired sh_pathcache[] entry for a name, or NULL
+ */
+static SHPATH *sh_pathfind(const BYTE *pname)
+{
+    SHPATH *e;
+
+    for (e = sh_pathcache; e < sh_pathcache+NUM_SHPATH; e++)
+    {
+        if (e->name[0] && (strcmp(e->name, pname) == 0))
+        {
+            if (hz_200 - e->stamp < (e->path[0] ? SHPATH_HIT : SHPATH_MISS))
+                return e;
+            e->name[0] = '\0';         /* expired */
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ *  Remember the result of searching the AES path for a name, replacing
+ *  the existing entry for the name, or else the oldest one
+ */
+static void sh_pathsave(const BYTE *pname, const BYTE *path)
+{
+    SHPATH *e, *victim = sh_pathcache;
+
+    if (strlen(pname) >= LEN_ZFNAME)    /* not a plain filename */
+        return;
+    if (strlen(path) >= LEN_ZPATH)      /* too long to be remembered */
+        return;
+
+    for (e = sh_pathcache; e < sh_pathcache+NUM_SHPATH; e++)
+    {
+        if (!e->name[0] || (strcmp(e->name, pname) == 0))
+        {
+            victim = e;
+            break;
+        }
+        if (e->stamp - victim->stamp < 0)
+            victim = e;
+    }
+
+    strcpy(victim->name, pname);
+    strcpy(victim->path, path);
+    victim->stamp = hz_200;
+}
+
+
 /*
  *  Routine to verify that a file is present.  Note that this routine
  *  tolerates the presence of wildcards in the filespec.
@@ -395,6 +496,8 @@ WORD sh_find(BYTE *pspec)
 {
     BYTE *path;
     BYTE *pname;
+    SHPATH *e = NULL;
+    BOOL cached;
 
     KDEBUG(("sh_find(): input pspec='%s'\n",pspec));
     pname = sh_name(pspec);                 /* get ptr to name      */
@@ -432,7 +535,7 @@ WORD sh_find(BYTE *pspec)
         return 1;
     }
 
-    /* (4) search in the AES path */
+    /* (4) search in the AES path, unless it was searched recently */
     sh_envrn(&path, PATH_ENV);      /* find PATH= in the command tail */
     if (!path)
     {
@@ -442,6 +545,25 @@ WORD sh_find(BYTE *pspec)
     if (!*path)                     /* skip nul after PATH= */
         path++;
 
+    cached = sh_pathcheck(path);
+    if (cached)
+        e = sh_pathfind(pname);
+    if (e)
+    {
+        if (!e->path[0])
+        {
+            KDEBUG(("sh_find(): '%s' recently not found\n",pspec));
+            return 0;
+        }
+        if (dos_sfirst(e->path, F_RDONLY | F_SYSTEM) == 0) /* still there */
+        {
+            strcpy(pspec, e->path);
+            KDEBUG(("sh_find(4): returning cached pspec='%s'\n",pspec));
+            return 1;
+        }
+        e->name[0] = '\0';             /* gone: search again */
+    }
+
     while(1)
     {
         path = sh_path(path, D.g_work, pname);
@@ -449,12 +571,16 @@ WORD sh_find(BYTE *pspec)
             break;
         if (dos_sfirst(D.g_work, F_RDONLY | F_SYSTEM) == 0) /* found */
         {
+            if (cached)
+                sh_pathsave(pname, D.g_work);   /* before pname is overwritten */
             strcpy(pspec, D.g_work);
             KDEBUG(("sh_find(4): returning pspec='%s'\n",pspec));
             return 1;
         }
     }
 
+    if (cached)
+        sh_pathsave(pname, "");
     KDEBUG(("sh_find(): '%s' not found\n",pspec));
     return 0;
 }
@@ -611,8 +737,7 @@ static WORD sh_ldapp(SHELL *psh)
         {
             KDEBUG(("sh_ldapp: appl_init() without appl_exit()\n"));
             mn_clsda();
-            if (rlr->p_qindex)
-                ap_rdwr(MU_MESAG, rlr, rlr->p_qindex, (WORD *)D.g_valstr);
+            q_flush(rlr);
             rlr->p_flags &= ~AP_OPEN;
         }
 
@@ -1,6 +1,6 @@
 /*
 *       Copyright 1999, Caldera Thin Clients, Inc.
-*                 2002-2017 The EmuTOS development team
+*                 2002-2026 The EmuTOS development team
 *
 *       This software is licenced under the GNU Public License.
 *       Please see LICENSE.TXT for further information.
@@ -13,6 +13,8 @@
 *       -------------------------------------------------------------
 */
 
+/* #define ENABLE_KDEBUG */
+
 #include "config.h"
 #include "portab.h"
 #include "struct.h"
@@ -26,27 +28,64 @@
 #include "geminit.h"
 #include "optimize.h"
 #include "gemwrect.h"
+#include "gemdos.h"
+#include "kprint.h"
+
 
+/*
+ * A window's owner rectangle list is a "banded" region, as in X11: the
+ * rectangles are sorted top to bottom, then left to right, and grouped
+ * in bands of rectangles that share the same y and height.  Within a
+ * band the rectangles neither overlap nor touch, and two vertically
+ * adjacent bands are merged when they have the same x extents.  So a
+ * region has exactly one representation, and as few rectangles as
+ * banding allows.
+ */
 
-#define TOP     0
-#define LEFT    1
-#define RIGHT   2
-#define BOTTOM  3
+#define MAXCOORD 0x7fff
 
+/*
+ * Extra ORECTs, on top of the NUM_ORECT in D.g_olist.  They are
+ * allocated by the first or_start(), which runs in the AES's own
+ * process, so that they stay valid for the whole session; later calls
+ * (wm_start() runs at every pass of sh_main()'s launch loop) only
+ * rebuild the free list.
+ */
+#define NUM_XORECT (NUM_ORECT * 3)
 
 static ORECT *rul;
+static ORECT *or_extra;
 static ORECT gl_mkrect;
 
 
-void or_start(void)
+static void or_addpool(ORECT *po, WORD n)
 {
-    WORD i;
+    for ( ; n > 0; n--, po++)
+    {
+        po->o_link = rul;
+        rul = po;
+    }
+}
+
 
+void or_start(void)
+{
     rul = NULL;
-    for (i = 0; i < NUM_ORECT; i++)
+    or_addpool(D.g_olist, NUM_ORECT);
+
+    if (!or_extra)
+        or_extra = dos_alloc_anyram(NUM_XORECT * sizeof(ORECT));
+    if (or_extra)
+        or_addpool(or_extra, NUM_XORECT);
+}
+
+
+void or_end(void)
+{
+    if (or_extra)
     {
-        D.g_olist[i].o_link = rul;
-        rul = &D.g_olist[i];
+        dos_free(or_extra);
+        or_extra = NULL;
     }
 }
 
@@ -62,124 +101,256 @@ ORECT *get_orect(void)
 }
 
 
-static ORECT *mkpiece(WORD tlrb, ORECT *new, ORECT *old)
+/*
+ *  Give a whole rectangle list back to the pool
+ */
+void or_free(ORECT *po)
 {
-    ORECT *rl;
+    ORECT   *r;
 
-    rl = get_orect();
-    rl->o_link = old;
+    if (!po)
+        return;
 
-    /* do common calcs */
-    rl->o_gr.g_x = old->o_gr.g_x;
-    rl->o_gr.g_w = old->o_gr.g_w;
-    rl->o_gr.g_y = max(old->o_gr.g_y, new->o_gr.g_y);
-    rl->o_gr.g_h = min(old->o_gr.g_y + old->o_gr.g_h, new->o_gr.g_y + new->o_gr.g_h) - rl->o_gr.g_y;
+    for (r = po; r->o_link; r = r->o_link)
+        ;
+    r->o_link = rul;
+    rul = po;
+}
 
-    /* use override calcs */
-    switch(tlrb)
+
+/*
+ *  Return the first rectangle following the band that po starts
+ */
+static const ORECT *band_end(const ORECT *po)
+{
+    WORD    y = po->o_gr.g_y;
+
+    while ((po = po->o_link) != NULL)
+    {
+        if (po->o_gr.g_y != y)
+            break;
+    }
+
+    return po;
+}
+
+
+static BOOL or_inside(WORD op, BOOL ina, BOOL inb)
+{
+    switch(op)
     {
-    case TOP:
-        rl->o_gr.g_y = old->o_gr.g_y;
-        rl->o_gr.g_h = new->o_gr.g_y - old->o_gr.g_y;
-        break;
-    case LEFT:
-        rl->o_gr.g_w = new->o_gr.g_x - old->o_gr.g_x;
-        break;
-    case RIGHT:
-        rl->o_gr.g_x = new->o_gr.g_x + new->o_gr.g_w;
-        rl->o_gr.g_w = (old->o_gr.g_x + old->o_gr.g_w) - (new->o_gr.g_x + new->o_gr.g_w);
-        break;
-    case BOTTOM:
-        rl->o_gr.g_y = new->o_gr.g_y + new->o_gr.g_h;
-        rl->o_gr.g_h = (old->o_gr.g_y + old->o_gr.g_h) - (new->o_gr.g_y + new->o_gr.g_h);
-        break;
+    case OR_UNION:
+        return ina || inb;
+    case OR_SECT:
+        return ina && inb;
     }
 
-    return rl;
+    return ina && !inb;                 /* OR_DIFF */
 }
 
 
-static ORECT *brkrct(ORECT *new, ORECT *r, ORECT *p)
+static ORECT **or_emit(ORECT **tail, WORD x, WORD y, WORD w, WORD h)
 {
-    WORD    i;
-    WORD    have_piece[4];
-
-    /* break up rectangle r based on new, adding new orects to list p */
-    if ((new->o_gr.g_x < r->o_gr.g_x + r->o_gr.g_w) &&
-        (new->o_gr.g_x + new->o_gr.g_w > r->o_gr.g_x) &&
-        (new->o_gr.g_y < r->o_gr.g_y + r->o_gr.g_h) &&
-        (new->o_gr.g_y + new->o_gr.g_h > r->o_gr.g_y))
+    ORECT   *po;
+
+    po = get_orect();
+    if (!po)
     {
-        /* there was overlap so we need new rectangles */
-        have_piece[TOP] = (new->o_gr.g_y > r->o_gr.g_y);
-        have_piece[LEFT] = (new->o_gr.g_x > r->o_gr.g_x);
-        have_piece[RIGHT] = ((new->o_gr.g_x + new->o_gr.g_w) < (r->o_gr.g_x + r->o_gr.g_w));
-        have_piece[BOTTOM] = ((new->o_gr.g_y + new->o_gr.g_h) < (r->o_gr.g_y + r->o_gr.g_h));
+        KDEBUG(("or_emit(): out of ORECTs\n"));
+        return tail;
+    }
+
+    po->o_link = NULL;
+    r_set(&po->o_gr, x, y, w, h);
+    *tail = po;
+
+    return &po->o_link;
+}
+
+
+/*
+ *  Combine the band from a to ea with the band from b to eb (either may
+ *  be empty) for the rows y to y+h-1, appending the result at tail
+ */
+static ORECT **or_band(ORECT **tail, const ORECT *a, const ORECT *ea,
+                       const ORECT *b, const ORECT *eb, WORD y, WORD h, WORD op)
+{
+    WORD    x, nx, start = 0;
+    BOOL    ina, inb, was = FALSE;
 
-        for (i = 0; i < 4; i++)
+    x = MAXCOORD;
+    if (a != ea)
+        x = a->o_gr.g_x;
+    if ((b != eb) && (b->o_gr.g_x < x))
+        x = b->o_gr.g_x;
+
+    /* step from one vertical edge to the next */
+    while ((a != ea) || (b != eb))
+    {
+        ina = (a != ea) && (a->o_gr.g_x <= x);
+        inb = (b != eb) && (b->o_gr.g_x <= x);
+
+        nx = MAXCOORD;
+        if (a != ea)
+            nx = ina ? a->o_gr.g_x + a->o_gr.g_w : a->o_gr.g_x;
+        if (b != eb)
+            nx = min(nx, inb ? b->o_gr.g_x + b->o_gr.g_w : b->o_gr.g_x);
+
+        if (or_inside(op, ina, inb))
+        {
+            if (!was)
+                start = x;
+            was = TRUE;
+        }
+        else if (was)
         {
-            if (have_piece[i])
-                p = (p->o_link = mkpiece(i, new, r));
+            tail = or_emit(tail, start, y, x - start, h);
+            was = FALSE;
         }
 
-        /* take out the old guy */
-        p->o_link = r->o_link;
-        r->o_link = rul;
-        rul = r;
-        return p;
+        x = nx;
+        while ((a != ea) && (a->o_gr.g_x + a->o_gr.g_w <= x))
+            a = a->o_link;
+        while ((b != eb) && (b->o_gr.g_x + b->o_gr.g_w <= x))
+            b = b->o_link;
     }
 
-    return NULL;
+    if (was)
+        tail = or_emit(tail, start, y, x - start, h);
+
+    return tail;
 }
 
 
-/* tree = place holder for everyobj */
-static void mkrect(OBJECT *tree, WORD wh)
+/*
+ *  If band (which directly follows prev in the list) continues prev
+ *  downwards with the same x extents, merge it into prev and return TRUE
+ */
+static BOOL or_coalesce(ORECT *prev, ORECT *band)
 {
-    WINDOW  *pwin;
-    ORECT   *new;
-    ORECT   *r, *p;
+    ORECT   *p, *q;
 
-    pwin = &D.w_win[wh];
+    if (prev->o_gr.g_y + prev->o_gr.g_h != band->o_gr.g_y)
+        return FALSE;
 
-    /* get the new rect that is used for breaking this windows rects */
-    new = &gl_mkrect;
+    for (p = prev, q = band; (p != band) && q; p = p->o_link, q = q->o_link)
+    {
+        if ((p->o_gr.g_x != q->o_gr.g_x) || (p->o_gr.g_w != q->o_gr.g_w))
+            return FALSE;
+    }
+    if ((p != band) || q)
+        return FALSE;
+
+    for (p = prev; p != band; p = p->o_link)
+        p->o_gr.g_h += band->o_gr.g_h;
+    or_free(band);
+
+    return TRUE;
+}
 
-    p = (ORECT *)&pwin->w_rlist;
-    r = p->o_link;
 
-    /* redo rectangle list */
-    while (r)
+/*
+ *  Return a new region that is the union (OR_UNION), intersection
+ *  (OR_SECT) or difference (OR_DIFF: a minus b) of regions a and b.
+ *  The regions are swept top to bottom, one horizontal band at a time:
+ *  a band ends wherever a band of a or b starts or ends.
+ */
+ORECT *or_op(const ORECT *a, const ORECT *b, WORD op)
+{
+    ORECT   *list = NULL, **tail = &list, **btail;
+    ORECT   *prev = NULL;
+    WORD    y, ny;
+    BOOL    ina, inb;
+
+    y = MAXCOORD;
+    if (a)
+        y = a->o_gr.g_y;
+    if (b)
+        y = min(y, b->o_gr.g_y);
+
+    while (a || b)
     {
-        if ((p=brkrct(new, r, p)) != 0)
+        ina = a && (a->o_gr.g_y <= y);
+        inb = b && (b->o_gr.g_y <= y);
+
+        ny = MAXCOORD;
+        if (a)
+            ny = ina ? a->o_gr.g_y + a->o_gr.g_h : a->o_gr.g_y;
+        if (b)
+            ny = min(ny, inb ? b->o_gr.g_y + b->o_gr.g_h : b->o_gr.g_y);
+
+        if ((ina || inb) && (ny > y))
         {
-            /* we broke a rectangle which means this can't be blt */
-            pwin->w_flags |=  VF_BROKEN;
-            r = p->o_link;
+            btail = tail;
+            tail = or_band(tail, a, ina ? band_end(a) : a,
+                           b, inb ? band_end(b) : b, y, ny - y, op);
+            if (tail != btail)
+            {
+                if (prev && or_coalesce(prev, *btail))
+                {
+                    *btail = NULL;
+                    tail = btail;
+                }
+                else
+                    prev = *btail;
+            }
         }
-        else
-            r = (p = r)->o_link;
+
+        y = ny;
+        if (ina && (a->o_gr.g_y + a->o_gr.g_h <= y))
+            a = band_end(a);
+        if (inb && (b->o_gr.g_y + b->o_gr.g_h <= y))
+            b = band_end(b);
     }
+
+    return list;
 }
 
 
-void newrect(OBJECT *tree, WORD wh)
+/* tree = place holder for everyobj; always visits the children */
+static BOOL mkrect(OBJECT *tree, WORD wh)
 {
     WINDOW  *pwin;
-    ORECT   *r, *new;
-    ORECT   *r0;
+    GRECT   *new;
+    ORECT   *r;
 
     pwin = &D.w_win[wh];
-    r0 = pwin->w_rlist;
 
-    /* dump rectangle list */
-    if (r0)
+    /* get the new rect that is used for breaking this windows rects */
+    new = &gl_mkrect.o_gr;
+
+    /* nothing to do unless it overlaps one of our rectangles */
+    for (r = pwin->w_rlist; r; r = r->o_link)
     {
-        for (r = r0; r->o_link; r = r->o_link)
-            ;
-        r->o_link = rul;
-        rul = r0;
+        if ((new->g_x < r->o_gr.g_x + r->o_gr.g_w) &&
+            (new->g_x + new->g_w > r->o_gr.g_x) &&
+            (new->g_y < r->o_gr.g_y + r->o_gr.g_h) &&
+            (new->g_y + new->g_h > r->o_gr.g_y))
+            break;
     }
+    if (!r)
+        return TRUE;
+
+    /* we broke a rectangle which means this can't be blt */
+    r = or_op(pwin->w_rlist, &gl_mkrect, OR_DIFF);
+    or_free(pwin->w_rlist);
+    pwin->w_rlist = r;
+    pwin->w_flags |=  VF_BROKEN;
+
+    return TRUE;
+}
+
+
+/* also an everyobj() callback, which always visits the children */
+BOOL newrect(OBJECT *tree, WORD wh)
+{
+    WINDOW  *pwin;
+    ORECT   *new;
+
+    pwin = &D.w_win[wh];
+
+    /* dump rectangle list */
+    or_free(pwin->w_rlist);
 
     /* zero the rectangle list */
     pwin->w_rlist = NULL;
@@ -190,7 +361,7 @@ void newrect(OBJECT *tree, WORD wh)
     /* if no size then return */
     w_getsize(WS_TRUE, wh, &gl_mkrect.o_gr);
     if (!(gl_mkrect.o_gr.g_w && gl_mkrect.o_gr.g_h))
-        return;
+        return TRUE;
 
     /* init. a global orect for use during mkrect calls */
     gl_mkrect.o_link = NULL;
@@ -200,7 +371,11 @@ void newrect(OBJECT *tree, WORD wh)
 
     /* get an orect in this window's list */
     new = get_orect();
+    if (!new)
+        return TRUE;
     new->o_link  = NULL;
     w_getsize(WS_TRUE, wh, &new->o_gr);
     pwin->w_rlist = new;
+
+    return TRUE;
 }
@@ -1,7 +1,7 @@
 /*
  * EmuTOS AES
  *
- * Copyright (C) 2002-2017 The EmuTOS development team
+ * Copyright (C) 2002-2026 The EmuTOS development team
  *
  * This file is distributed under the GPL, version 2 or at your
  * option any later version.  See doc/license.txt for details.
@@ -10,8 +10,16 @@
 #ifndef GEMWRECT_H
 #define GEMWRECT_H
 
+/* operations for or_op() */
+#define OR_UNION    0
+#define OR_SECT     1
+#define OR_DIFF     2
+
 void or_start(void);
+void or_end(void);
 ORECT *get_orect(void);
-void newrect(OBJECT *tree, WORD wh);
+void or_free(ORECT *po);
+ORECT *or_op(const ORECT *a, const ORECT *b, WORD op);
+BOOL newrect(OBJECT *tree, WORD wh);
 
 #endif
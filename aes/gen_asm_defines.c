@@ -63,7 +63,7 @@ void foo(void) {
 	ASMOFFSET(AESPD, p_evlist);
 	ASMOFFSET(AESPD, p_qdq);
 	ASMOFFSET(AESPD, p_qnq);
-	ASMOFFSET(AESPD, p_qaddr);
+	ASMOFFSET(AESPD, p_qhead);
 	ASMOFFSET(AESPD, p_qindex);
 	ASMOFFSET(AESPD, p_queue);
 	ASMOFFSET(AESPD, p_appdir);
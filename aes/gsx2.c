@@ -1,7 +1,7 @@
 /*
  * gsx2.c - VDI (GSX) bindings
  *
- * Copyright (C) 2014 The EmuTOS development team
+ * Copyright (C) 2014-2026 The EmuTOS development team
  *
  * Authors:
  *  VRI   Vincent Rivière
@@ -14,13 +14,53 @@
 #include "gsx2.h"
 #include "obdefs.h"
 #include "gsxdefs.h"
+#include "struct.h"
+#include "basepage.h"
+#include "gemdosif.h"
 
 VDIPB vdipb;
 
+#if CONF_WITH_AES_DIRECT_VDI
+/* the ROM VDI dispatcher, as called by its trap #2 handler */
+#ifdef __arm__
+int GSX_ENTRY(int op, VDIPB *paramblock);
+#endif
+
+/*
+ * The AES's own VDI calls may skip the trap if it would only lead to
+ * the ROM VDI anyway, and if they are made in the supervisor context of
+ * an AES call (the desktop calls the gsx_ functions from user mode).
+ */
+static BOOL vdi_direct(void)
+{
+    return rlr && rlr->p_uda->u_insuper
+        && !aestrap_intercepted() && !vditrap_intercepted();
+}
+#endif
+
 void gsx2(void)
 {
     vdipb.contrl = &contrl;
 
+#if CONF_WITH_AES_DIRECT_VDI
+    if (vdi_direct())
+    {
+#ifdef __arm__
+        GSX_ENTRY(0x73, &vdipb);
+#else
+        __asm__ volatile
+        (
+            "move.l  %0,d1\n\t"
+            "jsr     _GSX_ENTRY"
+        :
+        : "g"(&vdipb)
+        : "d0", "d1", "memory", "cc"
+        );
+#endif
+        return;
+    }
+#endif
+
 #ifdef __arm__
     register long _r1 __asm__("r1")=(long)(&vdipb);
     __asm__ volatile (
@@ -17,7 +17,7 @@
 
 #ifndef GEMSTRUCT_H
 #define GEMSTRUCT_H
-#include "config.h"                     /* for AES_STACK_SIZE */
+#include "config.h"                     /* for AES_STACK_SIZE etc. */
 
 typedef struct aespd   AESPD;           /* process descriptor           */
 typedef struct uda     UDA;             /* user stack data area         */
@@ -32,9 +32,9 @@ typedef UWORD   EVSPEC;
 
 #define NUM_PDS (NUM_ACCS + 2)          /* acc's + ctrlpd + dos appl.   */
 #define EVBS_PER_PD     5               /* EVBs per AES process */
-#define KBD_SIZE 8
-#define QUEUE_SIZE 128
-#define NFORKS 32
+#define KBD_SIZE AES_KBD_QUEUE_SIZE
+#define QUEUE_SIZE AES_QUEUE_SIZE
+#define NFORKS AES_FORK_QUEUE_SIZE
 
 struct cqueue               /* console keyboard queue */
 {
@@ -85,6 +85,7 @@ struct evb                  /* event block */
         WORD    e_flag;
         EVSPEC  e_mask;         /* mask for event notification */
         LONG    e_return;
+        WORD    e_slot;         /* index in dlheap[], while EVDELAY */
 } ;
 
 /* pd defines */
@@ -125,9 +126,12 @@ struct aespd                /* process descriptor */
             WORD wh;            /* window handle of applicable window */
         }       p_msg;
 
-        BYTE    *p_qaddr;       /* */
-        WORD    p_qindex;       /* */
-        BYTE    p_queue[QUEUE_SIZE];   /* */
+        WORD    p_qhead;        /* offset of the oldest byte in p_queue */
+        WORD    p_qindex;       /* number of bytes in p_queue */
+        ULONG   p_qread;        /* number of bytes ever read from p_queue */
+        ULONG   p_qredraw[NUM_WIN]; /* position of pending WM_REDRAW, per window */
+        ULONG   p_qarrow;       /* position of pending WM_ARROWED */
+        BYTE    p_queue[QUEUE_SIZE];   /* ring buffer */
         BYTE    p_appdir[LEN_ZPATH+2];  /* directory containing the executable */
                                         /* (includes trailing path separator)  */
 };
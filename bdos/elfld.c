@@ -416,21 +416,37 @@ static LONG elf_fixup(BYTE *load_base, const ELFINFO *info, LONG bias,
     else
         *slot += (ULONG)bias;
 
+#if CONF_WITH_PGM_CACHE
+    if (rela && type == ELF_R_RELATIVE)
+        pgmc_preset((LONG)(vaddr - info->link_base), addend);
+    pgmc_fixup((LONG)(vaddr - info->link_base));
+#endif
+
     return 0;
 }
 
+/*
+ * relocation records are read in chunks into a buffer: the free part of
+ * the TPA above the image when there is enough of it, otherwise this
+ * small one.
+ */
+#define RELBUF_COUNT    32
+static Elf32_Rela relbuf[RELBUF_COUNT];
+
 /* walk one SHT_REL / SHT_RELA section and relocate every entry in it */
 static LONG elf_relocate_section(FH h, const Elf32_Shdr *sh, BOOL rela,
                                  BYTE *load_base, const ELFINFO *info,
-                                 LONG bias)
+                                 LONG bias, BYTE *buf, ULONG buflen)
 {
-    Elf32_Rela ent;     /* a RELA record is a REL record plus an addend */
+    const Elf32_Rela *ent;  /* a RELA record is a REL record plus an addend */
+    const BYTE *p;
     ULONG structsize;
     ULONG entsize;
     ULONG offset;
     ULONG count;
     ULONG addend;
-    ULONG i;
+    ULONG per_chunk;
+    ULONG i, j, n;
     LONG r;
 
     structsize = rela ? (ULONG)sizeof(Elf32_Rela) : (ULONG)sizeof(Elf32_Rel);
@@ -448,25 +464,43 @@ static LONG elf_relocate_section(FH h, const Elf32_Shdr *sh, BOOL rela,
     if (entsize != structsize || (sh->sh_size % entsize) != 0)
         return EPLFMT;
 
-    if (sh->sh_size != 0UL && u32_add_overflow(sh->sh_offset, sh->sh_size, &offset))
+    if (sh->sh_size == 0UL)
+        return 0;
+
+    /* the whole table must be addressable through xlseek()/xread(), which
+     * take signed LONGs */
+    if (u32_add_overflow(sh->sh_offset, sh->sh_size, &offset)
+     || offset > (ULONG)0x7fffffffUL)
         return EPLFMT;
 
+    r = xlseek((LONG)sh->sh_offset, h, 0);
+    if (r < 0L)
+        return r;
+
+    /* the records are contiguous, so read as many as fit at a time */
     count = sh->sh_size / entsize;
-    for (i = 0; i < count; i++)
+    per_chunk = buflen / structsize;
+    for (i = 0; i < count; i += n)
     {
-        if (u32_mul_overflow(i, entsize, &offset)
-         || u32_add_overflow(sh->sh_offset, offset, &offset))
-            return EPLFMT;
+        n = count - i;
+        if (n > per_chunk)
+            n = per_chunk;
 
-        r = read_at(h, offset, &ent, (LONG)structsize);
+        r = xread(h, (LONG)(n * structsize), buf);
         if (r < 0L)
             return r;
+        if (r != (LONG)(n * structsize))
+            return EPLFMT;
 
-        addend = rela ? ent.r_addend : 0UL;
-        r = elf_fixup(load_base, info, bias, ent.r_offset,
-                      ELF32_R_TYPE(ent.r_info), rela, addend);
-        if (r < 0L)
-            return r;
+        for (j = 0, p = buf; j < n; j++, p += structsize)
+        {
+            ent = (const Elf32_Rela *)p;
+            addend = rela ? ent->r_addend : 0UL;
+            r = elf_fixup(load_base, info, bias, ent->r_offset,
+                          ELF32_R_TYPE(ent->r_info), rela, addend);
+            if (r < 0L)
+                return r;
+        }
     }
 
     return 0;
@@ -474,7 +508,7 @@ static LONG elf_relocate_section(FH h, const Elf32_Shdr *sh, BOOL rela,
 
 /* apply every relocation section retained by ld --emit-relocs */
 static LONG elf_relocate(FH h, const Elf32_Ehdr *e, BYTE *load_base,
-                         const ELFINFO *info, LONG bias)
+                         const ELFINFO *info, LONG bias, BYTE *buf, ULONG buflen)
 {
     Elf32_Shdr sh;
     ULONG shoff;
@@ -555,9 +589,9 @@ static LONG elf_relocate(FH h, const Elf32_Ehdr *e, BYTE *load_base,
         }
 
         if (sh.sh_type == SHT_REL)
-            r = elf_relocate_section(h, &sh, FALSE, load_base, info, bias);
+            r = elf_relocate_section(h, &sh, FALSE, load_base, info, bias, buf, buflen);
         else
-            r = elf_relocate_section(h, &sh, TRUE, load_base, info, bias);
+            r = elf_relocate_section(h, &sh, TRUE, load_base, info, bias, buf, buflen);
 
         if (r < 0L)
             return r;
@@ -579,6 +613,7 @@ LONG elf_pgmld(FH h, PD *p)
     Elf32_Phdr ph;
     ELFINFO info;
     BYTE *load_base;
+    BYTE *relocs;
     LONG bias;
     LONG tpalen;
     ULONG phoff;
@@ -673,7 +708,29 @@ LONG elf_pgmld(FH h, PD *p)
             return EPLFMT;
     }
 
-    return elf_relocate(h, &ehdr, load_base, &info, bias);
+#if CONF_WITH_PGM_CACHE
+    /*
+     * an image loaded at its link address gets no relocation at all, so
+     * there would be no list of fixups to replay at another address
+     */
+    if (bias != 0)
+        pgmc_record(load_base, (LONG)(info.file_end - info.link_base),
+                    (LONG)(info.mem_end - info.link_base),
+                    (LONG)(info.mem_end - info.file_end), info.link_base);
+#endif
+
+    /*
+     * the relocation records can be read into the TPA above the image, as
+     * that memory is not part of the program yet.  Relocating never
+     * touches it, since elf_fixup() only accepts slots inside the image.
+     */
+    relocs = (BYTE *)(((ULONG)load_base + (info.mem_end - info.link_base) + 3) & ~3UL);
+    if (relocs < p->p_hitpa && (ULONG)(p->p_hitpa - relocs) >= (ULONG)sizeof(relbuf))
+        return elf_relocate(h, &ehdr, load_base, &info, bias,
+                            relocs, (ULONG)(p->p_hitpa - relocs));
+
+    return elf_relocate(h, &ehdr, load_base, &info, bias,
+                        (BYTE *)relbuf, (ULONG)sizeof(relbuf));
 }
 
 #endif /* CONF_WITH_ELF_LOADER */
@@ -31,12 +31,47 @@ long ccfreeit;
 
 
 /*
- *  ffit - find first fit for requested memory in ospool
+ *  maxfree - length of the largest block of the free list
+ */
+static LONG maxfree(MPB *mp)
+{
+    MD *q;
+    LONG maxval;
+
+    if (mp->mp_maxfree)
+        return mp->mp_maxfree;
+
+    for (maxval = 0L, q = mp->mp_mfl; q; q = q->m_link)
+        if (q->m_length > maxval)
+            maxval = q->m_length;
+
+    if ((maxval & 3 ) != 0)
+    {
+        assert((maxval & 3 )== 0);
+        maxval &= ~3;
+    }
+    mp->mp_maxfree = maxval;
+
+    return maxval;
+}
+
+
+/*
+ *  ffit - find best fit for requested memory in ospool
+ *
+ *  The free list is kept in ascending address order, so that freeit()
+ *  can coalesce neighbouring blocks; the smallest block that is large
+ *  enough is used, the lowest one among equals, which leaves the large
+ *  blocks alone for as long as possible.  The length of the largest
+ *  free block is remembered in the MPB: a request for it, or for more
+ *  than it, needs no walk of the list at all.
  */
 MD *ffit(long amount, MPB *mp)
 {
     MD *p, *q, *p1;     /* free list is composed of MD's */
-    LONG maxval;
+    MD *best, *bestp;
+    LONG len, max1, max2;
+    BOOL exact;
 
 #ifdef ENABLE_KDEBUG
     if (mp == &pmd)
@@ -54,8 +89,7 @@ MD *ffit(long amount, MPB *mp)
     ++ccffit;
 #endif
 
-    p = (MD *)mp;
-    if ((q = mp->mp_mfl) == NULL)   /* get free list pointer */
+    if (mp->mp_mfl == NULL)         /* get free list pointer */
     {
         KDEBUG(("BDOS ffit: null free list ptr\n"));
         return NULL;
@@ -66,17 +100,9 @@ MD *ffit(long amount, MPB *mp)
      */
     if (amount == -1L)
     {
-        for (maxval = 0L; q; p = q, q = p->m_link)
-            if (q->m_length > maxval)
-                maxval = q->m_length;
-
-        if ((maxval & 3 ) != 0)
-        {
-            assert((maxval & 3 )== 0);
-            maxval &= ~3;
-        }
-        KDEBUG(("BDOS ffit: maxval=%ld\n",maxval));
-        return (MD *)maxval;
+        len = maxfree(mp);
+        KDEBUG(("BDOS ffit: maxval=%ld\n",len));
+        return (MD *)len;
     }
 
     if (mp == &pmd)
@@ -88,22 +114,51 @@ MD *ffit(long amount, MPB *mp)
      */
     amount = (amount + 3) & ~3;
 
+    if (mp->mp_maxfree && (amount > mp->mp_maxfree))
+    {
+        KDEBUG(("BDOS ffit: Not enough contiguous memory\n"));
+        return NULL;
+    }
+
     /*
-     * look for first free space that's large enough
-     * (this could be changed to a best-fit quite easily)
+     * look for the smallest free space that's large enough, keeping
+     * track of the two largest blocks on the way: once the best one
+     * is used, the largest free block is the remainder of it or the
+     * largest of the others
      */
-    for ( ; q; p = q, q = p->m_link)
+    best = bestp = NULL;
+    max1 = max2 = 0L;
+    for (p = (MD *)mp, q = mp->mp_mfl; q; p = q, q = p->m_link)
     {
-        if (q->m_length >= amount)
-            break;
+        len = q->m_length;
+        if (len > max1)
+        {
+            max2 = max1;
+            max1 = len;
+        }
+        else if (len > max2)
+            max2 = len;
+
+        if ((len >= amount) && (!best || (len < best->m_length)))
+        {
+            best = q;
+            bestp = p;
+            if (len == amount)      /* can't do better */
+                break;
+        }
     }
-    if (!q)
+    if (!best)
     {
         KDEBUG(("BDOS ffit: Not enough contiguous memory\n"));
+        mp->mp_maxfree = max1;
         return NULL;
     }
+    exact = (q != NULL);            /* the walk stopped early */
+    q = best;
+    p = bestp;
+    len = q->m_length;
 
-    if (q->m_length == amount)
+    if (len == amount)
         p->m_link = q->m_link;  /* take the whole thing */
     else
     {
@@ -120,7 +175,7 @@ MD *ffit(long amount, MPB *mp)
         }
 
         /* init new MD for remaining memory on free chain */
-        p1->m_length = q->m_length - amount;
+        p1->m_length = len - amount;
         p1->m_start = q->m_start + amount;
         p1->m_link = q->m_link;
         p->m_link = p1;
@@ -129,6 +184,23 @@ MD *ffit(long amount, MPB *mp)
         q->m_length = amount;
     }
 
+    /*
+     * update the largest free block.  After an early stop, only part of
+     * the list was seen: the largest block is unchanged if the one used
+     * was smaller, and must be looked for again otherwise.
+     */
+    if (exact)
+    {
+        if (len >= mp->mp_maxfree)
+            mp->mp_maxfree = 0L;
+    }
+    else
+    {
+        if (len == max1)
+            max1 = max2;
+        mp->mp_maxfree = (len - amount > max1) ? len - amount : max1;
+    }
+
     /*
      * link allocated block into allocated list & mark owner of block
      */
@@ -221,7 +293,14 @@ void freeit(MD *m, MPB *mp)
             q->m_length += p->m_length;
             q->m_link = p->m_link;
             xmfremd(p);
+            p = q;
         }
+
+    /*
+     * the freed block may now be the largest one
+     */
+    if (mp->mp_maxfree && (p->m_length > mp->mp_maxfree))
+        mp->mp_maxfree = p->m_length;
 }
 
 
@@ -269,3 +348,32 @@ WORD shrinkit(MD *m, MPB *mp, LONG newlen)
 
     return 0;
 }
+
+
+/*
+ *  carveit - take memory permanently from the free list
+ *
+ *  'len' bytes are cut from the top of the highest free block that is
+ *  larger than that, and belong to nobody afterwards, like the memory
+ *  kept by Ptermres().  No MD is needed, so this can be used while MDs
+ *  are short.  Returns NULL if no block is large enough.
+ */
+void *carveit(LONG len, MPB *mp)
+{
+    MD *q, *top;
+
+    len = (len + 3) & ~3;
+
+    for (q = mp->mp_mfl, top = NULL; q; q = q->m_link)
+        if (q->m_length > len)
+            top = q;
+
+    if (!top)
+        return NULL;
+
+    top->m_length -= len;
+    mp->mp_maxfree = 0L;            /* it may have been the largest */
+
+    KDEBUG(("BDOS carveit: start=%p, length=%ld\n",top->m_start+top->m_length,len));
+    return top->m_start + top->m_length;
+}
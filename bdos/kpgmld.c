@@ -32,9 +32,18 @@
 static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd);
 #endif
 #if CONF_WITH_PRG_LOADER || DETECT_NATIVE_FEATURES
-static LONG pgfix01(void *lastcp, LONG nrelbytes, PGMINFO *pi);
+static LONG pgfix01(BYTE **pcp, UBYTE *rp, UBYTE *end, PGMINFO *pi);
 #endif
 
+/* size of the magic word & program header at the start of a PRG file */
+#define PRG_HDR_SIZE    (2+sizeof(PGMHDR01))
+
+/*
+ * a symbol table up to this size is read along with the rest of the
+ * file, rather than skipped with a seek and a second read
+ */
+#define MAX_SYMREAD     16384L
+
 /*
  * executable format detected by kpgmhdrld() and consumed by kpgmld().
  * xexec() (the only caller) loads a program's header and body in two
@@ -70,6 +79,15 @@ LONG kpgmhdrld(char *s, PGMHDR01 *hd, FH *h)
         goto fail;
     }
 
+#if CONF_WITH_PGM_CACHE
+    /* a program loaded recently needs no parsing at all */
+    if (pgmc_find(*h, hd))
+    {
+        pgmld_format = PGMLD_CACHED;
+        return 0;
+    }
+#endif
+
 #if CONF_WITH_ELF_LOADER
     /* ELF binary linked with ld --emit-relocs (see elfld.c) */
     if (magic[0] == 0x7f && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F')
@@ -129,6 +147,11 @@ LONG kpgmld(PD *p, FH h, PGMHDR01 *hd)
     LONG r;
 
     switch (pgmld_format) {
+#if CONF_WITH_PGM_CACHE
+    case PGMLD_CACHED:
+        r = pgmc_load(p);
+        break;
+#endif
 #if CONF_WITH_ELF_LOADER
     case PGMLD_ELF:
         r = elf_pgmld(h, p);
@@ -146,6 +169,10 @@ LONG kpgmld(PD *p, FH h, PGMHDR01 *hd)
 
     KDEBUG(("BDOS pgmld: return code=0x%lx\n",r));
 
+#if CONF_WITH_PGM_CACHE
+    pgmc_commit(p, hd, r);
+#endif
+
     xclose(h);
     return r;
 }
@@ -156,25 +183,55 @@ LONG kpgmld(PD *p, FH h, PGMHDR01 *hd)
  * It is very similar to cp/m 68k load in the (open) program file with
  * handle 'h' using load file strategy like cp/m 68k.  Specifically:
  *
- * - read in program header and determine format parameters
- * - seek past the symbol table to the start of the relo info
- * - read in the first offset (it's different than the rest in that
- *   it is a longword instead of a byte).
- * - make the first adjustment until we run out of relocation info or
- *   we have an error
- * - read in relocation info into the bss area
- * - call pgfix01() to fix up the code using that info
+ * - read in the text & data, the symbol table if it is small, and as
+ *   much of the relocation info as fits in the rest of the TPA, with as
+ *   few reads as possible: normally the whole file in one go
+ * - get the first offset (it's different than the rest in that it is a
+ *   longword instead of a byte), and make the first adjustment
+ * - call pgfix01() to fix up the code using the rest of the info,
+ *   reading in more of it if it didn't all fit
  * - zero out the bss
  */
 #if CONF_WITH_PRG_LOADER
+
+/*
+ * pgrefill - read more relocation info
+ *
+ * The unused bytes from *prp to *pend are moved to the start of the bss,
+ * and the rest of the TPA (but for one byte, see pgfix01()) is filled
+ * from the file.  Returns the number of bytes read, 0 at end of file.
+ */
+static LONG pgrefill(FH h, UBYTE **prp, UBYTE **pend, PGMINFO *pi, BYTE *hitpa)
+{
+    UBYTE *buf = (UBYTE *)pi->pi_bbase;
+    LONG left = *pend - *prp;
+    LONG r;
+
+    memmove(buf, *prp, left);
+    *prp = buf;
+    *pend = buf + left;
+
+    r = (LONG)(hitpa - 1) - (LONG)*pend;
+    if (r <= 0)
+        return 0;
+
+    r = xread(h, r, *pend);
+    if (r > 0)
+        *pend += r;
+
+    return r;
+}
+
 static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
 {
     PGMINFO *pi;
     PD      *p;
     PGMINFO pinfo;
     BYTE    *cp;
+    UBYTE   *rp, *end;
     LONG    relst;
     LONG    flen;
+    LONG    filelen;
     LONG    r;
 
     pi = &pinfo;
@@ -208,37 +265,83 @@ static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
     memcpy(&p->p_tbase, &pi->pi_tbase, 6 * sizeof(long));
 
     /*
-     * read in the program file (text and data)
-     * if there is an error reading in the file or if it is an abs
-     * file, then we are finished
+     * if it is an abs file, read in the program file (text and data)
+     * and we are finished
      */
 
-    r = xread(h,flen,pi->pi_tbase);
-    if (r < 0)
-        return r;
-
     if (hd->h01_abs)
+    {
+        r = xread(h,flen,pi->pi_tbase);
+        if (r < 0)
+            return r;
+#if CONF_WITH_PGM_CACHE
+        pgmc_record(pi->pi_tbase, flen, flen + pi->pi_blen, 0L, 0UL);
+#endif
         return 0;           /* do we need to clr bss here? */
+    }
 
-    /*
-     * if not an absolute format, position past the symbols and start
-     * the reloc pointer (flen is tlen + dlen).
-     */
-
-    /**********  should change hard coded 0x1c  ******************/
-
-    KDEBUG(("BDOS pgmld01: flen=0x%lx, pi_slen=0x%lx\n",flen,pi->pi_slen));
+    filelen = xlseek(0L,h,2);
+    if (filelen < 0L)
+        return filelen;
 
-    r = xlseek(flen+pi->pi_slen+0x1c,h,0);
+    r = xlseek(PRG_HDR_SIZE,h,0);
     if (r < 0L)
         return r;
 
-    r = xread(h,(long)sizeof(relst),&relst);
+    KDEBUG(("BDOS pgmld01: flen=0x%lx, pi_slen=0x%lx, filelen=0x%lx\n",flen,pi->pi_slen,filelen));
+
+    if ((pi->pi_slen <= MAX_SYMREAD) && (filelen - (LONG)PRG_HDR_SIZE < pi->pi_tpalen))
+    {
+        /*
+         * the whole file fits in the TPA: read it with a single request,
+         * which the file system turns into one multi-sector transfer per
+         * contiguous run of clusters
+         */
+        r = xread(h,filelen-PRG_HDR_SIZE,pi->pi_tbase);
+        if (r < 0)
+            return r;
+        rp = (UBYTE *)pi->pi_bbase + pi->pi_slen;
+        end = (UBYTE *)pi->pi_tbase + r;
+        if (rp > end)               /* truncated file: no relocation info */
+            rp = end;
+    }
+    else
+    {
+        /*
+         * read the text and data, then position past the symbols: the
+         * relocation info will be read into the bss
+         */
+        r = xread(h,flen,pi->pi_tbase);
+        if (r < 0)
+            return r;
+
+        r = xlseek(PRG_HDR_SIZE+flen+pi->pi_slen,h,0);
+        if (r < 0L)
+            return r;
+        rp = end = (UBYTE *)pi->pi_bbase;
+    }
+
+    while (end - rp < (LONG)sizeof(relst))
+    {
+        r = pgrefill(h, &rp, &end, pi, p->p_hitpa);
+        if (r < 0L)
+            return r;
+        if (r == 0)
+            break;
+    }
+    if (end - rp >= (LONG)sizeof(relst))
+    {
+        memcpy(&relst, rp, sizeof(relst));
+        rp += sizeof(relst);
+    }
 
     KDEBUG(("BDOS pgmld01: relst=0x%lx\n",relst));
 
-    if (r < 0L)
-        return r;
+#if CONF_WITH_PGM_CACHE
+    /* the text and data are in, and not relocated yet */
+    pgmc_record(pi->pi_tbase, flen, flen + pi->pi_blen,
+                (hd->h01_flags & PF_FASTLOAD) ? pi->pi_blen : -1L, 0UL);
+#endif
 
     if (relst != 0)
     {
@@ -250,18 +353,20 @@ static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
             return EPLFMT;
 
         *((long *)(cp)) += (long)pi->pi_tbase ; /*  1st fixup     */
-
-        flen = (long)p->p_hitpa - (long)pi->pi_bbase;   /* M01.01.0925.01 */
+#if CONF_WITH_PGM_CACHE
+        pgmc_fixup(relst);
+#endif
 
         for ( ; ; )
         {
-            /*  read in more relocation info  */
-            r = xread(h,flen,pi->pi_bbase);
+            /*  do fixups using the info we have  */
+            r = pgfix01(&cp, rp, end, pi);
             if (r <= 0)
                 break;
 
-            /*  do fixups using that info  */
-            r = pgfix01(cp, r, pi);
+            /*  read in more relocation info  */
+            rp = end;
+            r = pgrefill(h, &rp, &end, pi, p->p_hitpa);
             if (r <= 0)
                 break;
         }
@@ -291,52 +396,57 @@ static LONG pgmld01(FH h, PD *pdptr, PGMHDR01 *hd)
 /*
  * pgfix01 - do the next set of fixups
  *
+ *  Applies the relocation bytes from rp up to end, or up to the 0 byte
+ *  that terminates them.  *pcp is the address of the last modified
+ *  longword in the code segment, and is updated.  The byte at end is
+ *  overwritten with a 0, so that the loop needs a single test per byte
+ *  rather than also counting the bytes: end must be writable.
+ *
  *  returns:
- *      addr of last modified longword in code segment (cp)
- *      0 if error or done
- *      stat01:
- *              >0: all offsets in bss used up, read in more
+ *              >0: all the bytes up to end used up, read in more
  *              =0: offset of 0 encountered, no more fixups
  *              <0: EPLFMT (load file format error)
  *
  * Arguments:
- *  nrelbytes - number of avail rel values
+ *  pcp       - ptr to the code pointer
+ *  rp, end   - the relocation bytes available
  *  pi        - program info pointer
  */
 
 #if CONF_WITH_PRG_LOADER || DETECT_NATIVE_FEATURES
-static LONG pgfix01(void *lastcp, LONG nrelbytes, PGMINFO *pi)
+static LONG pgfix01(BYTE **pcp, UBYTE *rp, UBYTE *end, PGMINFO *pi)
 {
     UBYTE *cp;              /*  code pointer                */
-    UBYTE *rp;              /*  relocation info pointer     */
-    LONG  n;                /*  nbr of relocation bytes     */
     UBYTE *bbase;           /*  base addr of bss segment    */
     LONG  tbase;            /*  base addr of text segment   */
+    UBYTE c;
 
-    cp = lastcp;
-    rp = (UBYTE *)pi->pi_bbase;
-    n = nrelbytes;
+    cp = (UBYTE *)*pcp;
     tbase = (LONG)pi->pi_tbase;
     bbase = (UBYTE *)pi->pi_bbase;
 
-    while(n-- && (*rp != 0))
+    *end = 0;               /*  sentinel                    */
+    while ((c = *rp++) != 0)
     {
-        if (*rp == 1)
+        if (c == 1)
             cp += 0xfe;
         else
         {
-            cp += *rp;  /* add the byte at rp to cp, don't sign ext */
+            cp += c;    /* add the byte at rp to cp, don't sign ext */
 
             if (cp >= bbase)
                 return EPLFMT;
             if (((LONG)cp) & 1)
                 return EPLFMT;
             *((long *)cp) += tbase;
+#if CONF_WITH_PGM_CACHE
+            pgmc_fixup((LONG)cp - tbase);
+#endif
         }
-        ++rp;
     }
+    *pcp = (BYTE *)cp;
 
-    return (++n == 0) ? 1 : 0;
+    return (rp > end) ? 1 : 0;
 }
 #endif /* CONF_WITH_PRG_LOADER || DETECT_NATIVE_FEATURES */
 
@@ -370,7 +480,7 @@ LONG kpgm_relocate(PD *p, long length)
     pi->pi_dbase = pi->pi_tbase + pi->pi_tlen;
 
     /* move the code to the right position (after the PD - basepage) */
-    memmove(p+1, (char*)(p+1) +2+sizeof(PGMHDR01), flen);
+    memmove(p+1, (char*)(p+1) +PRG_HDR_SIZE, flen);
 
     KDEBUG(("BDOS kpgm_relocate: tlen=0x%lx, dlen=0x%lx, slen=0x%lx\n",
             pi->pi_tlen,pi->pi_dlen,pi->pi_slen));
@@ -397,7 +507,7 @@ LONG kpgm_relocate(PD *p, long length)
         return 0;
 
     /* relocation information present */
-    rp = (LONG*) (pi->pi_tbase+2+sizeof(PGMHDR01)+flen+pi->pi_slen);
+    rp = (LONG*) (pi->pi_tbase+PRG_HDR_SIZE+flen+pi->pi_slen);
     if (*rp)
     {
         cp = pi->pi_tbase + *rp++;
@@ -413,7 +523,7 @@ LONG kpgm_relocate(PD *p, long length)
         memmove(pi->pi_bbase, rp, length);
 
         /* fixup with the reloc information available */
-        pgfix01(cp, length, pi);
+        pgfix01(&cp, (UBYTE *)pi->pi_bbase, (UBYTE *)pi->pi_bbase + length, pi);
     }
 
     /* clear the whole heap */
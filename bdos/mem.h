@@ -91,12 +91,14 @@ void set_owner(void *addr, PD *p);
  * in iumem.c
  */
 
-/* find first fit for requested memory in ospool */
+/* find best fit for requested memory in ospool */
 MD *ffit(long amount, MPB *mp);
 /* Free up a memory descriptor */
 void freeit(MD *m, MPB *mp);
 /* shrink a memory descriptor */
 WORD shrinkit(MD *m, MPB *mp, LONG newlen);
+/* take memory permanently from the free list */
+void *carveit(LONG len, MPB *mp);
 
 
 #endif /* MEM_H */
@@ -48,6 +48,16 @@
 /* size of os memory pool, in words: */
 #define LENOSM          (LEN_OSM_BLOCK*NUM_OSM_BLOCKS/sizeof(WORD))
 
+#if CONF_WITH_OSMEM_GROWTH
+/* the pool grows by chunks of this many blocks, taken from main RAM */
+#define OSM_CHUNK_BLOCKS 32
+#define LEN_OSM_CHUNK   (LEN_OSM_BLOCK*OSM_CHUNK_BLOCKS)    /* in bytes */
+#define MAX_OSM_CHUNKS  (CONF_OSMEM_GROW_LIMIT*1024L/LEN_OSM_CHUNK)
+
+/* the control word holds the root index, and the memory type + 1 */
+#define OSM_CONTROL(i,t) ((i) | (((t)+1) << 8))
+#endif
+
 
 /*
  *  local typedefs
@@ -74,6 +84,7 @@ struct _mdb {
 /*
  *  internal variables
  */
+static WORD *osmbase;        /* the current pool: osmem[], or a chunk */
 static WORD osmptr;
 static WORD osmlen;
 static WORD osmem[LENOSM];
@@ -103,6 +114,18 @@ static LONG dbgfreblk;
 static LONG dbggtosm;
 static LONG dbggtblk;
 
+#if CONF_WITH_OSMEM_GROWTH
+static WORD osm_chunks;                 /* chunks the pool has grown by */
+
+#ifdef ENABLE_KDEBUG
+/*
+ *  usage statistics, by memory type, reported by growosm()
+ */
+static WORD osm_inuse[MEMTYPE_OFD+1];   /* blocks in use */
+static WORD osm_peak[MEMTYPE_OFD+1];    /* highest number in use */
+#endif
+#endif
+
 
 /*
  * getosm - get a block of memory from the main o/s memory pool
@@ -124,13 +147,47 @@ static WORD *getosm(WORD n)
         return 0;
     }
 
-    m = &osmem[osmptr];         /*  start at base               */
+    m = &osmbase[osmptr];       /*  start at base               */
     osmptr += n;                /*  new base                    */
     osmlen -= n;                /*  new length of free block    */
     return m;                   /*  allocated memory            */
 }
 
 
+#if CONF_WITH_OSMEM_GROWTH
+/*
+ * growosm - make a new chunk of main RAM the o/s memory pool
+ *
+ * What is left of the previous pool is less than a block, and is lost.
+ * Returns 0 if the pool cannot grow any more.
+ */
+static WORD growosm(void)
+{
+    WORD *m;
+
+    if (osm_chunks >= MAX_OSM_CHUNKS)
+        return 0;
+
+    m = carveit(LEN_OSM_CHUNK, &pmd);
+    if (!m)
+        return 0;
+
+    osmbase = m;
+    osmptr = 0;
+    osmlen = LEN_OSM_CHUNK/sizeof(WORD);
+    osm_chunks++;
+
+    KDEBUG(("growosm(): chunk %d at %p, MDBLOCK/DMD/DND/OFD in use %d/%d/%d/%d, peak %d/%d/%d/%d\n",
+            osm_chunks,m,osm_inuse[MEMTYPE_MDBLOCK],osm_inuse[MEMTYPE_DMD],
+            osm_inuse[MEMTYPE_DND],osm_inuse[MEMTYPE_OFD],
+            osm_peak[MEMTYPE_MDBLOCK],osm_peak[MEMTYPE_DMD],
+            osm_peak[MEMTYPE_DND],osm_peak[MEMTYPE_OFD]));
+
+    return 1;
+}
+#endif
+
+
 /*
  *  unlink_mdblock - unlinks an MDBLOCK from the mdb chain
  *
@@ -295,7 +352,11 @@ void xmfremd(MD *md)
  * a list of blocks of size 64 bytes.  This list is singly linked and
  * blocks are deleted/removed in LIFO order from the root.  If there
  * are no free blocks on the list, we call getosm to get a block from
- * the os memory pool.
+ * the os memory pool.  With CONF_WITH_OSMEM_GROWTH, a pool that is used
+ * up is then replaced by a new chunk of main RAM, up to a limit.  This
+ * is not done for an MDBLOCK: those are requested by ffit() and the
+ * like, which are in the middle of working on the free list that the
+ * chunk would be taken from.
  *
  * If we cannot get memory for an MDBLOCK, we return NULL (the request
  * will fail).  Otherwise we will attempt to free up DNDs to make space
@@ -341,6 +402,11 @@ void *xmgetblk(WORD memtype)
             break;
         }
 
+#if CONF_WITH_OSMEM_GROWTH
+        if ((memtype != MEMTYPE_MDBLOCK) && growosm())
+            continue;
+#endif
+
         /* no memory available for an MDBLOCK, that's (sort of) OK */
         if (memtype == MEMTYPE_MDBLOCK)
             break;
@@ -367,6 +433,17 @@ void *xmgetblk(WORD memtype)
         for (j = 0; j < w; j++)
             *q++ = 0;
 
+#if CONF_WITH_OSMEM_GROWTH
+    if (m)
+    {
+        *(m - BLOCK_PAD) = OSM_CONTROL(i, memtype);
+#ifdef ENABLE_KDEBUG
+        if (++osm_inuse[memtype] > osm_peak[memtype])
+            osm_peak[memtype] = osm_inuse[memtype];
+#endif
+    }
+#endif
+
     return m;
 }
 
@@ -380,6 +457,18 @@ void xmfreblk(void *m)
 
     i = *(((WORD *)m) - BLOCK_PAD);
 
+#if CONF_WITH_OSMEM_GROWTH
+#ifdef ENABLE_KDEBUG
+    {
+        WORD t = (i >> 8) - 1;
+
+        if (((i & 0xff) == 4) && (t >= MEMTYPE_MDBLOCK) && (t <= MEMTYPE_OFD))
+            osm_inuse[t]--;
+    }
+#endif
+    i &= 0xff;      /* the high byte holds the memory type */
+#endif
+
     if (i != 4)
     {
         /*  bad index  */
@@ -406,6 +495,8 @@ void xmfreblk(void *m)
  */
 void osmem_init(void)
 {
+    osmbase = osmem;
+    osmptr = 0;
     osmlen = LENOSM;
     mdbroot = NULL;
     dbgfreblk = 0;
@@ -18,6 +18,7 @@
  */
 #define PGMLD_PRG   0       /* classic Atari GEMDOS PRG (m68k)      */
 #define PGMLD_ELF   1       /* ELF loader (ET_EXEC/-q or ET_DYN PIE)*/
+#define PGMLD_CACHED 2      /* image found in the program cache      */
 
 typedef struct
 {
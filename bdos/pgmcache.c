@@ -0,0 +1,357 @@
+/*
+ * pgmcache.c - cache of recently loaded program images
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * Programs started over and over again (a compiler run by a build script
+ * under EmuCON, say) are loaded from disk and relocated from scratch by
+ * every Pexec().  This keeps, in a fixed size static arena, the image of
+ * the programs loaded last as it was before relocation, along with the
+ * list of the longwords the loader relocated.  When the same file is
+ * started again, the image is copied into the TPA and the longwords get
+ * the new load bias added, without reading the file beyond its first
+ * bytes.
+ *
+ * A file is identified by what its directory entry holds: the drive,
+ * the starting cluster, the length and the date/time stamp, plus the
+ * first PGMC_HEADLEN bytes of the file.  Rewriting a program changes
+ * them, so there is no need to watch the writes.  Only files of the
+ * built-in FAT filesystem have a directory entry that can be looked at
+ * through their handle (see getofd()), so files on other pluggable
+ * filesystem drivers are simply never cached.
+ *
+ * The loaders feed the cache while loading: pgmc_record() copies the
+ * image before it is relocated, pgmc_fixup() records each relocated
+ * longword, and pgmc_commit() keeps the entry if the load succeeded.
+ * The least recently used entries are discarded to make room.
+ */
+
+/* #define ENABLE_KDEBUG */
+
+#include "config.h"
+
+#if CONF_WITH_PGM_CACHE
+
+#include "portab.h"
+#include "fs.h"
+#include "proc.h"
+#include "gemerror.h"
+#include "pghdr.h"
+#include "string.h"
+#include "kprint.h"
+
+#define PGMC_HEADLEN    32      /* bytes of the file compared on a hit */
+
+#define PGMC_ALIGN(n)   (((n) + 3) & ~3L)
+
+/*
+ * what identifies a program file.  It is compared with memcmp(), so it
+ * must always be cleared before being filled in.
+ */
+typedef struct {
+    WORD    drv;
+    CLNO    strtcl;
+    LONG    fileln;
+    DOSTIME td;
+    WORD    headlen;
+    UBYTE   head[PGMC_HEADLEN];
+} PGMCKEY;
+
+/*
+ * a cache entry.  It is followed by the image (padded to a multiple of
+ * 4 bytes), then by nfix LONG offsets of the longwords to relocate.
+ */
+typedef struct {
+    LONG    size;           /* of the whole entry, a multiple of 4      */
+    ULONG   stamp;          /* when last used, for the LRU policy       */
+    PGMCKEY key;
+    PGMHDR01 hd;            /* what kpgmhdrld() returns to proc.c       */
+    ULONG   link_base;      /* address the image is linked to run at    */
+    LONG    imglen;         /* size of the image                        */
+    LONG    need;           /* size of the program in memory            */
+    LONG    clear;          /* bytes to clear after the image, or -1    */
+    LONG    seg[6];         /* p_tbase..p_blen, bases relative to TPA   */
+    LONG    nfix;           /* number of longwords to relocate          */
+} PGMCENTRY;
+
+#define PGMC_ENTSIZE    PGMC_ALIGN((LONG)sizeof(PGMCENTRY))
+#define PGMC_IMAGE(e)   ((UBYTE *)(e) + PGMC_ENTSIZE)
+#define PGMC_FIXUPS(e)  ((LONG *)(PGMC_IMAGE(e) + PGMC_ALIGN((e)->imglen)))
+
+#define PGMC_ARENA      (CONF_PGM_CACHE_SIZE * 1024L)
+
+static LONG pgmc_arena[PGMC_ARENA / sizeof(LONG)];
+static LONG pgmc_used;          /* bytes of committed entries */
+static ULONG pgmc_clock;        /* LRU stamp of the latest hit */
+
+/*
+ * Between kpgmhdrld() and kpgmld(): the entry found, or the key of the
+ * file being loaded.  As for pgmld_format in kpgmld.c, the two steps
+ * are strictly serial, so one of each is enough.
+ */
+static PGMCENTRY *pgmc_hit;
+static PGMCKEY pgmc_key;
+static BOOL pgmc_keyok;
+
+/* the entry being recorded, at the end of the arena, or NULL */
+static PGMCENTRY *pgmc_rec;
+
+
+static PGMCENTRY *pgmc_entry(LONG offset)
+{
+    return (PGMCENTRY *)((UBYTE *)pgmc_arena + offset);
+}
+
+/* remove an entry, moving down those that follow it */
+static void pgmc_remove(PGMCENTRY *e)
+{
+    LONG size = e->size;
+    UBYTE *next = (UBYTE *)e + size;
+
+    KDEBUG(("pgmc_remove: entry of %ld bytes\n", size));
+    memmove(e, next, (UBYTE *)pgmc_arena + pgmc_used - next);
+    pgmc_used -= size;
+}
+
+/* remove the least recently used entry */
+static void pgmc_evict(void)
+{
+    PGMCENTRY *e, *lru = NULL;
+    LONG n;
+
+    for (n = 0; n < pgmc_used; n += e->size) {
+        e = pgmc_entry(n);
+        if (!lru || (LONG)(e->stamp - lru->stamp) < 0)
+            lru = e;
+    }
+    if (lru)
+        pgmc_remove(lru);
+}
+
+/*
+ * Build the key of an open file, FALSE if it cannot have one.  The file
+ * position is left just after the magic number.
+ */
+static BOOL pgmc_getkey(FH h, PGMCKEY *key)
+{
+    OFD *f = getofd(h);
+    DFD *dfd;
+    LONG r;
+
+    if (!f || !f->o_dmd)
+        return FALSE;
+    dfd = f->o_dfd;
+
+    bzero(key, sizeof(*key));
+    key->drv = f->o_dmd->m_drvnum;
+    key->strtcl = dfd->o_strtcl;
+    key->fileln = dfd->o_fileln;
+    key->td = dfd->o_td;
+
+    r = xlseek(0L, h, 0);
+    if (r < 0L)
+        return FALSE;
+    r = xread(h, (LONG)PGMC_HEADLEN, key->head);
+    if (r < 0L)
+        return FALSE;
+    key->headlen = (WORD)r;
+
+    return xlseek(4L, h, 0) >= 0L;
+}
+
+/*
+ * pgmc_find - look up the program open as h, called by kpgmhdrld()
+ *
+ * On a hit, the header the loader returned for it is copied to hd and
+ * TRUE is returned; pgmc_load() will then load it.  Otherwise the key
+ * is remembered, for pgmc_record() to use.
+ */
+BOOL pgmc_find(FH h, PGMHDR01 *hd)
+{
+    PGMCENTRY *e;
+    LONG n;
+
+    pgmc_hit = NULL;
+    pgmc_rec = NULL;
+    pgmc_keyok = pgmc_getkey(h, &pgmc_key);
+    if (!pgmc_keyok)
+        return FALSE;
+
+    for (n = 0; n < pgmc_used; n += e->size) {
+        e = pgmc_entry(n);
+        if (memcmp(&e->key, &pgmc_key, sizeof(pgmc_key)) == 0) {
+            KDEBUG(("pgmc_find: hit, %ld bytes, %ld fixups\n", e->imglen, e->nfix));
+            e->stamp = ++pgmc_clock;
+            memcpy(hd, &e->hd, sizeof(*hd));
+            pgmc_hit = e;
+            return TRUE;
+        }
+    }
+
+    /* an older version of the same file is of no further use */
+    for (n = 0; n < pgmc_used; ) {
+        e = pgmc_entry(n);
+        if (e->key.drv == pgmc_key.drv && e->key.strtcl == pgmc_key.strtcl)
+            pgmc_remove(e);
+        else
+            n += e->size;
+    }
+
+    return FALSE;
+}
+
+/*
+ * pgmc_load - load the program found by pgmc_find(), called by kpgmld()
+ */
+LONG pgmc_load(PD *p)
+{
+    PGMCENTRY *e = pgmc_hit;
+    UBYTE *load_base = (UBYTE *)(p + 1);
+    UBYTE *end;
+    LONG *fix;
+    ULONG bias;
+    LONG n;
+
+    pgmc_hit = NULL;
+    if (!e)
+        return EPLFMT;
+
+    if (e->need > p->p_hitpa - (BYTE *)load_base)
+        return ENSMEM;
+
+    memcpy(load_base, PGMC_IMAGE(e), e->imglen);
+
+    end = load_base + e->imglen;
+    n = (e->clear < 0) ? (UBYTE *)p->p_hitpa - end : e->clear;
+    if (n > 0)
+        bzero(end, n);
+
+    bias = (ULONG)load_base - e->link_base;
+    for (n = e->nfix, fix = PGMC_FIXUPS(e); n > 0; n--, fix++)
+        *(ULONG *)(load_base + *fix) += bias;
+
+    p->p_tbase = (BYTE *)load_base + e->seg[0];
+    p->p_tlen = e->seg[1];
+    p->p_dbase = (BYTE *)load_base + e->seg[2];
+    p->p_dlen = e->seg[3];
+    p->p_bbase = (BYTE *)load_base + e->seg[4];
+    p->p_blen = e->seg[5];
+
+    return 0;
+}
+
+/*
+ * pgmc_record - start recording the program being loaded
+ *
+ * image is the loaded image, before any relocation; the program needs
+ * 'need' bytes of TPA, of which 'clear' bytes after the image are
+ * cleared by the loader (-1 meaning the whole TPA).  link_base is the
+ * address the image would run at unrelocated.
+ */
+void pgmc_record(const BYTE *image, LONG imglen, LONG need, LONG clear, ULONG link_base)
+{
+    PGMCENTRY *e;
+    LONG want;
+
+    pgmc_rec = NULL;
+    if (!pgmc_keyok)
+        return;
+    pgmc_keyok = FALSE;
+
+    /* leave some room for the fixups, an eighth of the image is typical */
+    want = PGMC_ENTSIZE + PGMC_ALIGN(imglen) + imglen / 8;
+    if (imglen < 0 || want > PGMC_ARENA)
+        return;
+    while (pgmc_used + want > PGMC_ARENA)
+        pgmc_evict();
+
+    e = pgmc_entry(pgmc_used);
+    e->size = PGMC_ENTSIZE + PGMC_ALIGN(imglen);
+    memcpy(&e->key, &pgmc_key, sizeof(e->key));
+    e->link_base = link_base;
+    e->imglen = imglen;
+    e->need = need;
+    e->clear = clear;
+    e->nfix = 0;
+    memcpy(PGMC_IMAGE(e), image, imglen);
+
+    pgmc_rec = e;
+}
+
+/*
+ * pgmc_fixup - record that the longword at offset in the image gets the
+ * load bias added.  The recording is given up if there is no room left,
+ * or if the longword is not in the image copied by pgmc_record().
+ */
+void pgmc_fixup(LONG offset)
+{
+    PGMCENTRY *e = pgmc_rec;
+
+    if (!e)
+        return;
+
+    if ((offset < 0) || (offset > e->imglen - (LONG)sizeof(ULONG))
+     || (pgmc_used + e->size + (LONG)sizeof(LONG) > PGMC_ARENA)) {
+        KDEBUG(("pgmc_fixup: giving up at offset 0x%lx\n", offset));
+        pgmc_rec = NULL;
+        return;
+    }
+
+    PGMC_FIXUPS(e)[e->nfix++] = offset;
+    e->size += sizeof(LONG);
+}
+
+/*
+ * pgmc_preset - set the longword at offset in the recorded image, for a
+ * relocation that replaces the longword rather than adding to it
+ */
+void pgmc_preset(LONG offset, ULONG value)
+{
+    PGMCENTRY *e = pgmc_rec;
+
+    if (!e)
+        return;
+
+    if ((offset < 0) || (offset > e->imglen - (LONG)sizeof(ULONG))) {
+        pgmc_rec = NULL;
+        return;
+    }
+
+    *(ULONG *)(PGMC_IMAGE(e) + offset) = value;
+}
+
+/*
+ * pgmc_commit - end of a load, called by kpgmld() with its return code
+ *
+ * The entry being recorded is kept if the load succeeded.
+ */
+void pgmc_commit(const PD *p, const PGMHDR01 *hd, LONG r)
+{
+    PGMCENTRY *e = pgmc_rec;
+    BYTE *load_base = (BYTE *)(p + 1);
+
+    pgmc_rec = NULL;
+    pgmc_keyok = FALSE;
+    if (!e || r != 0)
+        return;
+
+    memcpy(&e->hd, hd, sizeof(e->hd));
+    e->seg[0] = p->p_tbase - load_base;
+    e->seg[1] = p->p_tlen;
+    e->seg[2] = p->p_dbase - load_base;
+    e->seg[3] = p->p_dlen;
+    e->seg[4] = p->p_bbase - load_base;
+    e->seg[5] = p->p_blen;
+    e->stamp = ++pgmc_clock;
+    pgmc_used += e->size;
+
+    KDEBUG(("pgmc_commit: %ld bytes, %ld fixups, %ld bytes used\n",
+            e->imglen, e->nfix, pgmc_used));
+}
+
+#endif /* CONF_WITH_PGM_CACHE */
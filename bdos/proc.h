@@ -43,6 +43,18 @@ LONG elf_pgmhdrld(FH h, PGMHDR01 *hd);
 LONG elf_pgmld(FH h, PD *p);
 #endif
 
+#if CONF_WITH_PGM_CACHE
+/*
+ * in pgmcache.c
+ */
+BOOL pgmc_find(FH h, PGMHDR01 *hd);
+LONG pgmc_load(PD *p);
+void pgmc_record(const BYTE *image, LONG imglen, LONG need, LONG clear, ULONG link_base);
+void pgmc_fixup(LONG offset);
+void pgmc_preset(LONG offset, ULONG value);
+void pgmc_commit(const PD *p, const PGMHDR01 *hd, LONG r);
+#endif
+
 #if DETECT_NATIVE_FEATURES
 LONG kpgm_relocate( PD *p, long length); /* SOP */
 #endif
@@ -396,6 +396,9 @@ long xmaddalt(UBYTE *start, LONG size)
      || (start < end_stram))
         return -1;
 
+    /* the largest free block must be looked for again */
+    pmdalt.mp_maxfree = 0L;
+
     /* if the new block is just after a free one, just extend it */
     for (p = pmdalt.mp_mfl; p; p = p->m_link) {
         if (p->m_start + p->m_length == start) {
@@ -472,6 +475,7 @@ void umem_init(void)
 {
     /* get the MPB */
     Getmpb((long)&pmd);
+    pmd.mp_maxfree = 0L;        /* not known yet */
 
     /* derive the addresses, assuming the MPB is in clean state */
     start_stram = pmd.mp_mfl->m_start;
@@ -26,6 +26,9 @@
 #include "xbios.h"
 #include "sound.h"
 #include "mfp.h"
+#ifdef MACHINE_RPI
+#include "raspi_screen.h"
+#endif
 
 // ==== Definitions ==========================================================
 
@@ -91,6 +94,9 @@ void int_vbl(void)
         blink();
 #if CONF_WITH_FDC
         flopvbl();
+#endif
+#if CONF_WITH_RASPI_SHADOW
+        raspi_shadow_vbl();     // present the planar ST screen, if any
 #endif
         // vblqueue handling
         vbl_list = (PFVOID*)vblqueue;
@@ -121,11 +127,88 @@ void int_timerc(void)
 #       if CONF_WITH_YM2149
             sndirq();   // dosound support
 #       endif
+        etv_timer(timer_ms);    // GEMDOS clock, VDI/AES timers
         // Fake vbl interrupt every 4 timer_c calls (50Hz)
         int_vbl();
     }
 }
 
+#if CONF_WITH_TICKLESS_IDLE
+// ==== Tickless idle ========================================================
+// Called by the AES, with interrupts disabled, when it has nothing to run:
+// ticks is the number of ticks until its next timer event, 0 if none.
+// Rather than being woken up by every tick, the CPU sleeps until that
+// event or until any other interrupt; the ticks skipped meanwhile are run
+// by the first tick interrupt after tick_resume(), so they come late but
+// none is lost.  The tick is left alone while a key repeats, while a key
+// waits in the buffer (the AES only takes it when it has room), while
+// the VBL has a mouse cursor to draw, and while anything but the system
+// hangs on the tick (see tick_hooked()).
+#define MAX_IDLE_TICKS  40      // 200 ms, the longest the AES may oversleep
+
+// The timer chain: etv_timer after the GEMDOS clock hooked it, before any
+// boot sector or AUTO program could, then etv_timer and the VDI's timer
+// vector once the VDI and the AES have hooked them in turn.
+static void (*boot_etv_timer)(int);
+static void (*stock_etv_timer)(int);
+static void (*stock_tim_addr)(int);
+static BOOL stock_chain;
+
+void tickless_boot(void)
+{
+    boot_etv_timer = etv_timer;
+}
+
+void tickless_start(void)
+{
+    stock_etv_timer = etv_timer;
+    stock_tim_addr = linea_vars.tim_addr;
+    stock_chain = (linea_vars.tim_chain == boot_etv_timer);
+}
+
+// TRUE if some program has a routine on the timer chains or in the VBL
+// queue, other than the VDI's mouse cursor routine in its first slot, or
+// if the VBL presents a planar screen: they expect their calls on time,
+// so the tick must not be deferred
+static BOOL tick_hooked(void)
+{
+    LONG *vbl = vblqueue;
+    WORD i;
+
+#if CONF_WITH_RASPI_SHADOW
+    if (raspi_shadow_active())
+        return TRUE;
+#endif
+
+    if (!stock_chain || (etv_timer != stock_etv_timer)
+     || (linea_vars.tim_addr != stock_tim_addr))
+        return TRUE;
+
+    for (i = 1; i < nvbls; i++)
+        if (vbl[i])
+            return TRUE;
+
+    return FALSE;
+}
+
+void tickless_idle(ULONG ticks)
+{
+    if (ticks == 0 || ticks > MAX_IDLE_TICKS)
+        ticks = MAX_IDLE_TICKS;
+
+    if (ticks < 2 || kb_repeat_pending() || bconstat2() || linea_vars.draw_flag
+     || tick_hooked())
+    {
+        stop_until_interrupt();
+        return;
+    }
+
+    tick_defer(ticks);
+    stop_until_interrupt();     // wakes up even with interrupts masked
+    tick_resume();
+}
+#endif
+
 // A side effect of that we are using a dispatch routine to calculate the correct
 // vector number, the r0 register should contain the (simulated) vector address.
 static void any_vec(int vector_addr, exception_frame_t* stack_frame, ULONG fsr, ULONG far)
@@ -835,6 +835,10 @@ void biosmain(void)
 
     KDEBUG(("bootflags = 0x%02x\n", bootflags));
 
+#if CONF_WITH_TICKLESS_IDLE
+    tickless_boot();            /* the timer chain before anything is loaded */
+#endif
+
 #if CONF_WITH_BOOT_SECTOR
     /* boot eventually from a block device (floppy or harddisk) */
     blkdev_boot();
@@ -519,6 +519,13 @@ void kb_timerc_int(void)
     do_key_repeat();
 }
 
+#if CONF_WITH_TICKLESS_IDLE
+BOOL kb_repeat_pending(void)
+{
+    return kb_ticks > 0;
+}
+#endif
+
 
 /*=== interrupt routine support ===================================*/
 
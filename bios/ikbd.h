@@ -99,6 +99,11 @@ extern void kbd_int(UBYTE scancode);
 /* called by timer C int to handle key repeat */
 extern void kb_timerc_int(void);
 
+#if CONF_WITH_TICKLESS_IDLE
+/* TRUE while a key is held down, so the 50 Hz tick must keep running */
+extern BOOL kb_repeat_pending(void);
+#endif
+
 /* some bios functions */
 extern LONG bconstat2(void);
 extern LONG bconin2(void);
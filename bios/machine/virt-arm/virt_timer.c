@@ -24,48 +24,87 @@
 #define VIRT_TIMER_PPI_PHYS   30      /* non-secure physical timer, fixed by the GIC/generic-timer binding */
 
 static ULONG ticks_per_hz;
+static UQUAD next_tick;         /* counter value at which the next tick is due */
+
+static UQUAD read_counter(void)
+{
+    ULONG low, high;
+
+    asm volatile ("mrrc p15, 0, %0, %1, c14" : "=r" (low), "=r" (high));  /* CNTPCT */
+
+    return (UQUAD) high << 32 | low;
+}
+
+static void set_compare(UQUAD cval)
+{
+    /* the timer interrupt is a level: a past value fires at once */
+    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" ((ULONG)(cval & 0xffffffffUL)),
+                                                "r" ((ULONG)(cval >> 32)));
+}
 
 static void virt_timer_tick(void)
 {
-    ULONG cval_low, cval_high;
-    UQUAD cval;
+    UQUAD now;
+    WORD late = 0;
 
 #if CONF_SERIAL_CONSOLE && CONF_WITH_VIRT_UART
     virt_uart0_poll_rx();
 #endif
 
-    /* virt_timer_init() connects and enables this IRQ well before
-     * mfp.c's init_system_timer() sets vector_5ms (that happens much
-     * later in bios_init()'s sequence) -- so the first several ticks
-     * can legitimately arrive with vector_5ms still NULL. Guard it,
-     * unlike raspi's raspi_timer3_handler() which can call vector_5ms()
-     * unconditionally because raspi only ever connects/enables its
-     * timer IRQ from inside init_system_timer(), after vector_5ms is
-     * already set. */
-    if (vector_5ms)
-        vector_5ms();
-
-    asm volatile ("mrrc p15, 2, %0, %1, c14" : "=r" (cval_low), "=r" (cval_high));
-    cval = ((UQUAD) cval_high << 32 | cval_low) + ticks_per_hz;
-    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" ((ULONG)(cval & 0xffffffffUL)),
-                                                "r" ((ULONG)(cval >> 32)));
+    /* Normally one tick is due here; after tick_defer() or a long
+     * stretch with interrupts masked, every tick that was missed is
+     * run now, so that hz_200 does not fall behind. */
+    now = read_counter();
+    while (now >= next_tick)
+    {
+        next_tick += ticks_per_hz;
+
+        /* virt_timer_init() connects and enables this IRQ well before
+         * mfp.c's init_system_timer() sets vector_5ms (that happens much
+         * later in bios_init()'s sequence) -- so the first several ticks
+         * can legitimately arrive with vector_5ms still NULL. Guard it,
+         * unlike raspi's raspi_timer3_handler() which can call vector_5ms()
+         * unconditionally because raspi only ever connects/enables its
+         * timer IRQ from inside init_system_timer(), after vector_5ms is
+         * already set. */
+        if (vector_5ms)
+            vector_5ms();
+
+        if (++late >= MAX_LATE_TICKS)
+        {
+            next_tick = now + ticks_per_hz;
+            break;
+        }
+    }
+
+    set_compare(next_tick);
+}
+
+#if CONF_WITH_TICKLESS_IDLE
+
+void tick_defer(UWORD ticks)
+{
+    set_compare(next_tick + (UQUAD)(ticks - 1) * ticks_per_hz);
 }
 
+void tick_resume(void)
+{
+    set_compare(next_tick);
+}
+
+#endif /* CONF_WITH_TICKLESS_IDLE */
+
 void virt_timer_init(void)
 {
     ULONG cntfrq;
-    ULONG cval_low, cval_high;
-    UQUAD cval;
 
     asm volatile ("mrc p15, 0, %0, c14, c0, 0" : "=r" (cntfrq));
     ticks_per_hz = cntfrq / HZ;
 
     virt_connect_irq(VIRT_TIMER_PPI_PHYS, virt_timer_tick);
 
-    asm volatile ("mrrc p15, 0, %0, %1, c14" : "=r" (cval_low), "=r" (cval_high));
-    cval = ((UQUAD) cval_high << 32 | cval_low) + ticks_per_hz;
-    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" ((ULONG)(cval & 0xffffffffUL)),
-                                                "r" ((ULONG)(cval >> 32)));
+    next_tick = read_counter() + ticks_per_hz;
+    set_compare(next_tick);
     asm volatile ("mcr p15, 0, %0, c14, c2, 1" :: "r" (1));   /* CNTP_CTL: ENABLE */
     flush_prefetch_buffer();    /* ISB: the timer is live from here on */
 }
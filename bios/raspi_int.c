@@ -96,8 +96,22 @@ typedef struct {
 
 static ULONG ticks_per_hz;
 
+/* the ARM generic timer: a 64-bit counter, CNTFRQ counts per second */
+typedef UQUAD TIMERCOUNT;
+#define TICK_PERIOD             ticks_per_hz
+#define TICK_DUE(now)           ((now) >= next_tick)
+
+#else
+
+/* the system timer: the low 32 bits of a 1 MHz counter, which wrap */
+typedef ULONG TIMERCOUNT;
+#define TICK_PERIOD             (CLOCKHZ / HZ)
+#define TICK_DUE(now)           ((LONG)((now) - next_tick) >= 0)
+
 #endif
 
+static TIMERCOUNT next_tick;    /* counter value at which the next tick is due */
+
 #if !defined(TARGET_RPI4)
 
 static PFVOID raspi_irq_handlers[IRQ_LINES];
@@ -140,42 +154,94 @@ static inline void disable_irq(int num)
 
 #endif /* !TARGET_RPI4 */
 
-void raspi_timer3_handler(void)
+static TIMERCOUNT read_counter(void)
+{
+#if defined(TARGET_RPI4)
+    ULONG cntpct_low, cntpct_high;
+
+    asm volatile ("mrrc p15, 0, %0, %1, c14" : "=r" (cntpct_low),
+                                               "=r" (cntpct_high));
+    return (UQUAD) cntpct_high << 32 | cntpct_low;
+#else
+    return ARM_SYSTIMER.count_lo;
+#endif
+}
+
+/*
+ * Program the tick interrupt for when.  The generic timer interrupt is a
+ * level, which a past value raises at once.  The system timer only
+ * matches on equality: a compare value the counter has already passed
+ * would not fire before the counter wraps, 71 minutes later, so it is
+ * moved just ahead of the counter instead.
+ */
+static void set_compare(TIMERCOUNT when)
 {
 #if defined(TARGET_RPI4)
-    ULONG cntp_cval_low, cntp_cval_high;
-    UQUAD cntp_cval;
+    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" ((ULONG)(when & 0xffffffffU)),
+                                                "r" ((ULONG)(when >> 32)));
 #else
-    ULONG compare;
+    peripheral_begin();
+    ARM_SYSTIMER.compare[3] = when;
+    while ((LONG)(ARM_SYSTIMER.count_lo - when) >= 0
+           && !(ARM_SYSTIMER.control & (1 << 3)))
+    {
+        when = ARM_SYSTIMER.count_lo + 2;
+        ARM_SYSTIMER.compare[3] = when;
+    }
+    peripheral_end();
 #endif
+}
+
+void raspi_timer3_handler(void)
+{
+    TIMERCOUNT now;
+    WORD late = 0;
 
 #if CONF_SERIAL_CONSOLE && CONF_WITH_RASPI_UART0
     raspi_uart0_poll_rx();
 #endif
 
-    vector_5ms();
-
-#if defined(TARGET_RPI4)
-    asm volatile ("mrrc p15, 2, %0, %1, c14" : "=r" (cntp_cval_low),
-                                               "=r" (cntp_cval_high));
-    cntp_cval = ((UQUAD) cntp_cval_high << 32 | cntp_cval_low) + ticks_per_hz;
-    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" (cntp_cval & 0xffffffffU),
-                                                "r" (cntp_cval >> 32));
-#else
+#if !defined(TARGET_RPI4)
     peripheral_begin();
-    compare = ARM_SYSTIMER.compare[3] + CLOCKHZ / HZ;
-    ARM_SYSTIMER.compare[3] = compare;
+    ARM_SYSTIMER.control = (1 << 3);    /* acknowledge the match */
+    peripheral_end();
+#endif
 
-    if (compare < ARM_SYSTIMER.count_lo)
+    /*
+     * Normally one tick is due here; after tick_defer() or a long
+     * stretch with interrupts masked, every tick that was missed is
+     * run now, so that hz_200 does not fall behind.
+     */
+    now = read_counter();
+    while (TICK_DUE(now))
     {
-        compare = ARM_SYSTIMER.count_lo + CLOCKHZ / HZ;
-        ARM_SYSTIMER.compare[3] = compare;
+        next_tick += TICK_PERIOD;
+        vector_5ms();
+
+        if (++late >= MAX_LATE_TICKS)
+        {
+            next_tick = now + TICK_PERIOD;
+            break;
+        }
     }
-    ARM_SYSTIMER.control = (1 << 3);
-    peripheral_end();
-#endif
+
+    set_compare(next_tick);
+}
+
+#if CONF_WITH_TICKLESS_IDLE
+
+void tick_defer(UWORD ticks)
+{
+    set_compare(next_tick + (TIMERCOUNT)(ticks - 1) * TICK_PERIOD);
+}
+
+void tick_resume(void)
+{
+    set_compare(next_tick);
 }
 
+#endif /* CONF_WITH_TICKLESS_IDLE */
+
 // int_timerc(), the Timer C interrupt handler this machine's tick drives
 // through vector_5ms, is machine-independent and lives in
 // bios/arch/arm/vectors.c, shared by every ARM machine.
@@ -197,20 +263,15 @@ void raspi_interrupt_init(void)
 void raspi_init_system_timer(void)
 {
 #if defined(TARGET_RPI4)
-    ULONG cntpct_low, cntpct_high;
     ULONG cntfrq;
-    UQUAD cntp_cval;
 
     asm volatile ("mrc p15, 0, %0, c14, c0, 0" : "=r" (cntfrq)); /* CNTFRQ */
     ticks_per_hz = cntfrq / HZ;
 
     raspi_gic_connect_irq(30, raspi_timer3_handler);
 
-    asm volatile ("mrrc p15, 0, %0, %1, c14" : "=r" (cntpct_low),
-                                               "=r" (cntpct_high));
-    cntp_cval = ((UQUAD) cntpct_high << 32 | cntpct_low) + ticks_per_hz;
-    asm volatile ("mcrr p15, 2, %0, %1, c14" :: "r" (cntp_cval & 0xffffffffU),
-                                                "r" (cntp_cval >> 32)); /* CNTP_CVAL */
+    next_tick = read_counter() + ticks_per_hz;
+    set_compare(next_tick);                                 /* CNTP_CVAL */
     asm volatile ("mcr p15, 0, %0, c14, c2, 1" :: "r" (1)); /* CNTP_CTL: ENABLE */
     flush_prefetch_buffer();
 #else
@@ -248,7 +309,8 @@ void raspi_init_system_timer(void)
 #endif
 
     ARM_SYSTIMER.count_lo = (ULONG) -(30 * CLOCKHZ);
-    ARM_SYSTIMER.compare[3] = ARM_SYSTIMER.count_lo + CLOCKHZ / HZ;
+    next_tick = ARM_SYSTIMER.count_lo + CLOCKHZ / HZ;
+    ARM_SYSTIMER.compare[3] = next_tick;
     // peripheral_end();
 
     // Set up timer 3 interrupt to emulate the ST 200Hz timer
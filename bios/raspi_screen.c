@@ -243,6 +243,11 @@ void raspi_get_current_mode_info(UWORD *planes, UWORD *hz_rez, UWORD *vt_rez)
 }
 
 void raspi_get_current_mode_desc(SCREEN_MODE_DESC *desc)
+{
+    raspi_get_native_mode_desc(desc);
+}
+
+void raspi_get_native_mode_desc(SCREEN_MODE_DESC *desc)
 {
     desc->width = raspi_screen_width;
     desc->height = raspi_screen_height;
@@ -256,16 +261,59 @@ void raspi_get_current_mode_desc(SCREEN_MODE_DESC *desc)
 
 void raspi_setphys(const UBYTE *addr)
 {
+#if CONF_WITH_RASPI_SHADOW
+    raspi_shadow_setphys(addr);
+#endif
+}
+
+/*
+ * Set the logical base, rez being what Setscreen() is about to select.
+ * With an ST resolution, the address is the logical screen of the shadow
+ * (see raspi_shadow.c): v_bas_ad, hence line-A, the VT52 console and the
+ * VDI, stays on the framebuffer, whose geometry they have.
+ */
+void raspi_setlog(UBYTE *addr, WORD rez)
+{
+#if CONF_WITH_RASPI_SHADOW
+    BOOL shadow = (rez >= 0 && rez < 8) ? (rez <= ST_HIGH) : raspi_shadow_active();
+
+    if (shadow) {
+        raspi_shadow_setlog(addr);
+        return;
+    }
+#endif
+    v_bas_ad = addr;
+}
 
+UBYTE *raspi_logbase(void)
+{
+#if CONF_WITH_RASPI_SHADOW
+    if (raspi_shadow_active())
+        return raspi_shadow_logbase();
+#endif
+    return v_bas_ad;
 }
 
 UBYTE *raspi_physbase(void)
+{
+#if CONF_WITH_RASPI_SHADOW
+    if (raspi_shadow_active())
+        return CONST_CAST(UBYTE *, raspi_shadow_physbase());
+#endif
+    return raspi_screenbase;
+}
+
+UBYTE *raspi_framebuffer(void)
 {
     return raspi_screenbase;
 }
 
 WORD raspi_setcolor(WORD colorNum, WORD color)
 {
+#if CONF_WITH_RASPI_SHADOW
+    if (raspi_shadow_active())
+        return raspi_shadow_setcolor(colorNum, color);
+#endif
     if (colorNum == 0)
         return 0x777;
     else
@@ -273,9 +321,19 @@ WORD raspi_setcolor(WORD colorNum, WORD color)
 
 }
 
+/*
+ * An ST resolution selects the planar shadow screen (see raspi_shadow.c),
+ * anything else the native screen, for which Getrez() reports FALCON_REZ.
+ */
 void raspi_setrez(WORD rez, WORD videlmode)
 {
-
+#if CONF_WITH_RASPI_SHADOW
+    if (rez <= ST_HIGH)
+        raspi_shadow_enter(rez);
+    else
+        raspi_shadow_exit();
+    sshiftmod = raspi_shadow_active() ? raspi_shadow_rez : FALCON_REZ;
+#endif
 }
 
 WORD raspi_vgetmode(void)
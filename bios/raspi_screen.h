@@ -16,8 +16,12 @@ void raspi_screen_init(void);
 WORD raspi_check_moderez(WORD moderez);
 void raspi_get_current_mode_info(UWORD *planes, UWORD *hz_rez, UWORD *vt_rez);
 void raspi_get_current_mode_desc(SCREEN_MODE_DESC *desc);
+void raspi_get_native_mode_desc(SCREEN_MODE_DESC *desc);
 void raspi_setphys(const UBYTE *addr);
+void raspi_setlog(UBYTE *addr, WORD rez);
+UBYTE *raspi_logbase(void);
 UBYTE *raspi_physbase(void);
+UBYTE *raspi_framebuffer(void);
 WORD raspi_setcolor(WORD colorNum, WORD color);
 void raspi_setrez(WORD rez, WORD videlmode);
 WORD raspi_vgetmode(void);
@@ -29,6 +33,22 @@ void raspi_neg_cell(UBYTE * cell);
 
 void initialise_raspi_palette(WORD mode);
 
+/* planar ST screen emulation, see raspi_shadow.c */
+#if CONF_WITH_RASPI_SHADOW
+extern WORD raspi_shadow_rez;
+#define raspi_shadow_active()   (raspi_shadow_rez >= 0)
+void raspi_shadow_enter(WORD rez);
+void raspi_shadow_exit(void);
+const UBYTE *raspi_shadow_physbase(void);
+UBYTE *raspi_shadow_logbase(void);
+void raspi_shadow_setlog(UBYTE *addr);
+void raspi_shadow_setphys(const UBYTE *addr);
+WORD raspi_shadow_setcolor(WORD colorNum, WORD color);
+void raspi_shadow_vbl(void);
+#else
+#define raspi_shadow_active()   FALSE
+#endif
+
 #if 0
 void raspi_screen_debug(void);
 void raspi_screen_err(ULONG num, ULONG addr, ULONG pc);
@@ -0,0 +1,338 @@
+/*
+ * raspi_shadow.c - planar ST screen emulation on the Raspberry Pi
+ *
+ * Copyright (C) 2026 The pTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * The Pi framebuffer is packed RGB565, so a program that switches to an
+ * ST resolution with Setscreen() and then writes to Physbase() directly
+ * would get nothing sensible on screen.  While such a resolution is
+ * selected, Physbase() and Logbase() therefore point at a shadow screen
+ * in the classic ST layout (interleaved bitplanes, 16 pixels per word
+ * group), and the VBL converts it onto the framebuffer, scaled by whole
+ * factors and centred.  Page flipping through Setscreen() works as on
+ * the ST: the VBL presents whatever the physical base points at.
+ *
+ * Only the programs writing to the screen directly see the shadow.
+ * v_bas_ad, hence line-A, the VT52 console and the VDI, stays on the
+ * framebuffer with its native geometry, and Setscreen() doesn't
+ * reinitialise them meanwhile: they would overrun a screen sized for the
+ * ST, and the VDI has no planar backend here anyway.
+ *
+ * Every VBL, each line of the physical screen is compared with a copy
+ * of what was presented last time, and only the lines that differ are
+ * converted again.  A palette change redraws the whole screen.  The
+ * plane-to-pixel conversion is table-driven: one byte of a plane
+ * expands to the bits of eight 4-bit pixel indices, so eight pixels
+ * take one lookup per plane.
+ */
+
+/* #define ENABLE_KDEBUG */
+
+#include "config.h"
+#ifndef MACHINE_RPI
+#error This file must only be compiled for raspberry PI targets
+#endif
+
+#include "portab.h"
+#include "raspi_screen.h"
+#include "screen.h"
+#include "tosvars.h"
+#include "string.h"
+#include "kprint.h"
+
+#define SHADOW_SIZE     32000UL         /* every ST resolution uses 32000 bytes */
+
+WORD raspi_shadow_rez = -1;             /* the ST resolution, -1 when off */
+
+/*
+ * The shadow screen itself (a 256-byte aligned ST screen, as programs
+ * may expect) and the copy of what was presented last.
+ */
+static UBYTE shadow_screen[SHADOW_SIZE] __attribute__((aligned(256)));
+static UBYTE shadow_shown[SHADOW_SIZE];
+
+static const UBYTE *shadow_phys;        /* what the VBL presents */
+static const UBYTE *requested_phys;     /* set before the mode is */
+static UBYTE *shadow_log;               /* what Logbase() returns */
+static UBYTE *requested_log;            /* set before the mode is */
+
+static UWORD shadow_palette[16];        /* ST(e) format */
+static UWORD shadow_pixel[16];          /* RGB565 */
+static BOOL shadow_redraw;              /* next VBL redraws all lines */
+
+/* for each plane byte, bit k (from the left) set in nibble k */
+static ULONG expand[256];
+
+/* the framebuffer area used: scale factors and top left corner */
+static WORD scale_x, scale_y;
+static UWORD *frame_origin;
+static LONG frame_pitch;                /* in pixels */
+
+static const UWORD st_default_palette[16] = {
+    0x777, 0x700, 0x070, 0x770, 0x007, 0x707, 0x077, 0x555,
+    0x333, 0x733, 0x373, 0x773, 0x337, 0x737, 0x377, 0x000
+};
+
+struct st_mode {
+    UWORD width;
+    UWORD height;
+    UWORD planes;
+    UWORD aspect;       /* pixel height / width */
+};
+
+static const struct st_mode st_modes[3] = {
+    { 320, 200, 4, 1 },         /* ST_LOW */
+    { 640, 200, 2, 2 },         /* ST_MEDIUM */
+    { 640, 400, 1, 1 }          /* ST_HIGH */
+};
+
+
+/*
+ * STe palette nibble (bit 3 is the least significant bit) to 8 bits
+ */
+static UBYTE ste_level(UWORD nibble)
+{
+    UWORD v = ((nibble & 7) << 1) | ((nibble >> 3) & 1);
+
+    return v * 17;
+}
+
+static UWORD rgb565(UWORD color)
+{
+    UBYTE r = ste_level(color >> 8);
+    UBYTE g = ste_level(color >> 4);
+    UBYTE b = ste_level(color);
+
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+static void update_pixels(void)
+{
+    int i;
+
+    if (raspi_shadow_rez == ST_HIGH) {
+        /* like the ST monochrome monitor: bit 0 of colour 0 inverts */
+        UWORD white = rgb565(0x777), black = rgb565(0x000);
+
+        shadow_pixel[0] = (shadow_palette[0] & 1) ? white : black;
+        shadow_pixel[1] = (shadow_palette[0] & 1) ? black : white;
+    } else {
+        for (i = 0; i < 16; i++)
+            shadow_pixel[i] = rgb565(shadow_palette[i]);
+    }
+    shadow_redraw = TRUE;
+}
+
+static void init_expand(void)
+{
+    int b, k;
+
+    for (b = 0; b < 256; b++) {
+        ULONG v = 0;
+
+        for (k = 0; k < 8; k++)
+            if (b & (0x80 >> k))
+                v |= 1UL << (4 * k);
+        expand[b] = v;
+    }
+}
+
+/*
+ * Clear the whole framebuffer to black
+ */
+static void clear_frame(void)
+{
+    SCREEN_MODE_DESC desc;
+    UBYTE *fb = raspi_framebuffer();
+
+    raspi_get_native_mode_desc(&desc);
+    bzero(fb, (ULONG)desc.pitch * desc.height);
+}
+
+
+/*
+ * raspi_shadow_enter - switch to the planar shadow screen
+ *
+ * Called by raspi_setrez() for an ST resolution.
+ */
+void raspi_shadow_enter(WORD rez)
+{
+    const struct st_mode *m = &st_modes[rez];
+    SCREEN_MODE_DESC desc;
+    WORD sx, sy, s;
+
+    raspi_get_native_mode_desc(&desc);
+    sx = desc.width / m->width;
+    sy = desc.height / (m->height * m->aspect);
+    s = (sx < sy) ? sx : sy;
+    if (s < 1) {
+        KDEBUG(("raspi_shadow_enter(%d): framebuffer too small\n", rez));
+        return;
+    }
+
+    if (!expand[1])
+        init_expand();
+
+    if (raspi_shadow_rez < 0) {
+        memcpy(shadow_palette, st_default_palette, sizeof(shadow_palette));
+        shadow_phys = requested_phys ? requested_phys : shadow_screen;
+        shadow_log = requested_log ? requested_log : CONST_CAST(UBYTE *, shadow_phys);
+    }
+    requested_phys = NULL;
+    requested_log = NULL;
+
+    raspi_shadow_rez = rez;
+    scale_x = s;
+    scale_y = s * m->aspect;
+    frame_pitch = desc.pitch / sizeof(UWORD);
+    frame_origin = (UWORD *)raspi_framebuffer()
+        + (desc.height - m->height * scale_y) / 2 * frame_pitch
+        + (desc.width - m->width * scale_x) / 2;
+
+    KDEBUG(("raspi_shadow_enter(%d): scale %dx%d\n", rez, scale_x, scale_y));
+
+    clear_frame();
+    update_pixels();
+}
+
+/*
+ * raspi_shadow_exit - back to the native truecolor screen
+ */
+void raspi_shadow_exit(void)
+{
+    if (raspi_shadow_rez < 0)
+        return;
+
+    raspi_shadow_rez = -1;
+    requested_phys = NULL;
+    requested_log = NULL;
+    clear_frame();
+}
+
+const UBYTE *raspi_shadow_physbase(void)
+{
+    return shadow_phys;
+}
+
+/*
+ * Set the physical base.  Before an ST resolution is selected (Setscreen()
+ * sets the address first), it is remembered for raspi_shadow_enter().
+ */
+void raspi_shadow_setphys(const UBYTE *addr)
+{
+    if (raspi_shadow_rez < 0) {
+        requested_phys = (addr == raspi_framebuffer()) ? NULL : addr;
+        return;
+    }
+    shadow_phys = addr;
+}
+
+UBYTE *raspi_shadow_logbase(void)
+{
+    return shadow_log;
+}
+
+/*
+ * Set the logical base, remembered for raspi_shadow_enter() before an ST
+ * resolution is selected, like the physical one
+ */
+void raspi_shadow_setlog(UBYTE *addr)
+{
+    if (raspi_shadow_rez < 0) {
+        requested_log = (addr == raspi_framebuffer()) ? NULL : addr;
+        return;
+    }
+    shadow_log = addr;
+}
+
+WORD raspi_shadow_setcolor(WORD colorNum, WORD color)
+{
+    WORD old;
+
+    colorNum &= 0x0f;
+    old = shadow_palette[colorNum];
+    if (color >= 0) {
+        shadow_palette[colorNum] = color & 0x0fff;
+        update_pixels();
+    }
+
+    return old;
+}
+
+
+/*
+ * Convert one line of n word groups into RGB565 pixels, each of them
+ * repeated scale_x times.  planes is 4, 2 or 1.
+ */
+static void convert_line(const UWORD *src, UWORD *dst, WORD groups, WORD planes)
+{
+    const WORD sx = scale_x;
+    WORD g, half, k, n;
+
+    for (g = 0; g < groups; g++, src += planes) {
+        for (half = 8; half >= 0; half -= 8) {
+            ULONG idx = expand[(src[0] >> half) & 0xff];
+
+            if (planes > 1) {
+                idx |= expand[(src[1] >> half) & 0xff] << 1;
+                if (planes > 2) {
+                    idx |= expand[(src[2] >> half) & 0xff] << 2;
+                    idx |= expand[(src[3] >> half) & 0xff] << 3;
+                }
+            }
+            for (k = 0; k < 8; k++, idx >>= 4) {
+                UWORD pixel = shadow_pixel[idx & 0x0f];
+
+                for (n = sx; n > 0; n--)
+                    *dst++ = pixel;
+            }
+        }
+    }
+}
+
+/*
+ * raspi_shadow_vbl - present the shadow screen, called every VBL
+ */
+void raspi_shadow_vbl(void)
+{
+    const struct st_mode *m;
+    const UBYTE *src;
+    UBYTE *shown;
+    UWORD *dst;
+    WORD bytes, y, r;
+
+    if (raspi_shadow_rez < 0 || !shadow_phys)
+        return;
+
+    /* Setpalette() leaves its palette for the next VBL, as on the ST */
+    if (colorptr) {
+        memcpy(shadow_palette, colorptr, sizeof(shadow_palette));
+        colorptr = NULL;
+        update_pixels();
+    }
+
+    m = &st_modes[raspi_shadow_rez];
+    bytes = m->width * m->planes / 8;
+
+    src = shadow_phys;
+    shown = shadow_shown;
+    dst = frame_origin;
+    for (y = 0; y < m->height; y++, src += bytes, shown += bytes) {
+        UWORD *line = dst;
+
+        dst += frame_pitch * scale_y;
+        if (!shadow_redraw && !memcmp(src, shown, bytes))
+            continue;
+        memcpy(shown, src, bytes);
+
+        convert_line((const UWORD *)src, line, m->width / 16, m->planes);
+        for (r = 1; r < scale_y; r++)
+            memcpy(line + r * frame_pitch, line, m->width * scale_x * sizeof(UWORD));
+    }
+    shadow_redraw = FALSE;
+}
@@ -569,6 +569,7 @@ static void screen_init_mode(void)
     sshiftmod = rez;
 #elif defined(MACHINE_RPI)
     initialise_palette_registers(0,0);
+    sshiftmod = FALCON_REZ;     /* the native screen is not an ST resolution */
 #endif /* CONF_WITH_ATARI_VIDEO */
     MAYBE_UNUSED(get_default_palmode);
 }
@@ -1000,7 +1001,11 @@ static void setphys(const UBYTE *addr)
 
 UBYTE *logbase(void)
 {
+#ifdef MACHINE_RPI
+    return raspi_logbase();
+#else
     return v_bas_ad;
+#endif
 }
 
 WORD getrez(void)
@@ -1030,7 +1035,11 @@ WORD getrez(void)
 void setscreen(UBYTE *logLoc, const UBYTE *physLoc, WORD rez, WORD videlmode)
 {
     if (logLoc != (UBYTE *)-1) {
+#ifdef MACHINE_RPI
+        raspi_setlog(logLoc, rez);
+#else
         v_bas_ad = logLoc;
+#endif
         KDEBUG(("v_bas_ad = %p\n", v_bas_ad));
     }
     if (physLoc != (UBYTE *)-1) {
@@ -1048,10 +1057,16 @@ void setscreen(UBYTE *logLoc, const UBYTE *physLoc, WORD rez, WORD videlmode)
         atari_setrez(rez, videlmode);
 #endif
 
-        /* Re-initialize line-a, VT52 etc: */
-        linea_init();
-        font_set_default(-1);
-        vt52_init();
+#if CONF_WITH_RASPI_SHADOW
+        /* line-A & VT52 stay on the framebuffer, see raspi_shadow.c */
+        if (!raspi_shadow_active())
+#endif
+        {
+            /* Re-initialize line-a, VT52 etc: */
+            linea_init();
+            font_set_default(-1);
+            vt52_init();
+        }
     }
 
     /* handle EmuCON extension */
@@ -91,6 +91,19 @@ extern WORD trap_save_area[];
 /* Non-Atari hardware vectors */
 #if !CONF_WITH_MFP
 extern void (*vector_5ms)(void);              /* 200 Hz system timer */
+
+/*
+ * A late tick interrupt runs every tick it has missed, so that hz_200
+ * keeps time, but no more than this many: beyond that (interrupts
+ * masked for over a second), the lost time is given up.
+ */
+#define MAX_LATE_TICKS  200
+#endif
+
+#if CONF_WITH_TICKLESS_IDLE
+void tick_defer(UWORD ticks);   /* no tick interrupt for the next ticks-1 ticks */
+void tick_resume(void);         /* back to one interrupt per tick */
+void tickless_boot(void);       /* see tickless_start() */
 #endif
 
 /* protect d2/a2 when calling external user-supplied code */
@@ -27,4 +27,11 @@ void set_cache(WORD enable);
 BOOL can_shutdown(void);
 #endif
 
+#if CONF_WITH_TICKLESS_IDLE
+/* wait for an interrupt, for at most ticks 200 Hz ticks (0 = no limit) */
+void tickless_idle(ULONG ticks);
+/* called by the AES once it has hooked the timer tick */
+void tickless_start(void);
+#endif
+
 #endif /* BIOSEXT_H */
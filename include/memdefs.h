@@ -46,6 +46,8 @@ struct _mpb
         MD      *mp_mfl;    /* memory free list */
         MD      *mp_mal;    /* memory allocated list */
         MD      *mp_rover;  /* roving pointer - no longer used */
+        /* the following is BDOS private, and not filled by Getmpb() */
+        LONG    mp_maxfree; /* largest free block, 0 if not known */
 };
 
 #endif  /* _MEMDEFS_H */
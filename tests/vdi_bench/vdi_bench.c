@@ -0,0 +1,433 @@
+/*
+ * vdi_bench.c - VDI drawing micro-benchmarks
+ *
+ * Not a correctness test: drives the common drawing primitives (v_bar,
+ * v_gtext, vro_cpyfm, vrt_cpyfm, v_pline, v_fillarea, v_contourfill)
+ * over a few representative sizes and write modes, and prints how many
+ * calls per second each one manages on the running screen mode -- so
+ * that a regression, or a claimed speedup, in one of the VDI renderers
+ * (planar, RGB565, XRGB8888) shows up as a number.  It only fails if
+ * the VDI itself can't be reached.
+ *
+ * Timing uses the 200 Hz system timer: each case runs for at least
+ * BENCH_TICKS ticks, starting on a tick boundary, so the figures are
+ * good to about one percent.  A finer timer isn't available from user
+ * mode on every machine (the ARM generic timer's counter is only
+ * readable there if the kernel allows it), and the coarse one is
+ * enough at this run length.
+ *
+ * Copyright (C) 2026 The pTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "test.h"
+#include <mint/osbind.h>
+#include <mint/mintbind.h>     /* Ssystem() */
+
+void test_vdi_bench(void);
+
+#define BENCH_TICKS     50      /* 1/4 s per case */
+
+#define HZ_200          0x4baL  /* documented address of the 200 Hz counter */
+
+/*
+ * Mirrors include/vdipb.h's VDICONTROL -- not shared via a header since
+ * this is userland/libcmini code, not kernel code.  On ARM, the two
+ * pointers are naturally aligned, one WORD further on.
+ */
+typedef struct {
+    short code;
+    short nptsin;
+    short nptsout;
+    short nintin;
+    short nintout;
+    short subcode;
+    short handle;
+#ifdef __arm__
+    short pad;
+#endif
+    void *ptr1;
+    void *ptr2;
+#ifndef __arm__
+    short filler;
+#endif
+} VDICONTROL;
+
+typedef struct {
+    void *fd_addr;
+    short fd_w;
+    short fd_h;
+    short fd_wdwidth;
+    short fd_stand;
+    short fd_nplanes;
+    short fd_r1, fd_r2, fd_r3;
+} MFDB;
+
+static VDICONTROL contrl;
+static short intin[128], ptsin[128], intout[128], ptsout[128];
+static struct {
+    VDICONTROL *contrl;
+    short *intin, *ptsin, *intout, *ptsout;
+} vdipb = { &contrl, intin, ptsin, intout, ptsout };
+
+static short handle;
+static short scr_w, scr_h, planes;
+static MFDB screen;             /* fd_addr NULL: the screen */
+static MFDB icon;               /* a 64x64 monochrome form */
+static unsigned short icon_data[64*4];
+
+static void vdi_trap(void)
+{
+#ifdef __arm__
+    register long r0 __asm__("r0") = 0x73;
+    register void *r1 __asm__("r1") = &vdipb;
+
+    __asm__ volatile("svc 2"
+                     : "+r"(r0), "+r"(r1)
+                     :
+                     : "r2", "r3", "ip", "lr", "cc", "memory");
+#else
+    __asm__ volatile("move.l %0,d1\n\t"
+                     "moveq #0x73,d0\n\t"
+                     "trap #2"
+                     :
+                     : "g"(&vdipb)
+                     : "d0", "d1", "d2", "a0", "a1", "a2", "cc", "memory");
+#endif
+}
+
+static void vdi(short code, short nptsin, short nintin, short subcode)
+{
+    contrl.code = code;
+    contrl.nptsin = nptsin;
+    contrl.nintin = nintin;
+    contrl.subcode = subcode;
+    contrl.handle = handle;
+    vdi_trap();
+}
+
+static void set1(short code, short value)
+{
+    intin[0] = value;
+    vdi(code, 0, 1, 0);
+}
+
+#define vswr_mode(m)        set1(32, m)
+#define vsl_type(t)         set1(15, t)
+#define vsl_color(c)        set1(17, c)
+#define vst_color(c)        set1(22, c)
+#define vsf_interior(i)     set1(23, i)
+#define vsf_style(s)        set1(24, s)
+#define vsf_color(c)        set1(25, c)
+#define vsf_perimeter(p)    set1(104, p)
+
+static void rect(short x1, short y1, short x2, short y2)
+{
+    ptsin[0] = x1;
+    ptsin[1] = y1;
+    ptsin[2] = x2;
+    ptsin[3] = y2;
+}
+
+static void vs_clip(short on, short x1, short y1, short x2, short y2)
+{
+    rect(x1, y1, x2, y2);
+    intin[0] = on;
+    vdi(129, 2, 1, 0);
+}
+
+/* 200 Hz ticks: Ssystem() where there is one, else a supervisor peek */
+static long read_hz_200(void)
+{
+    return *(volatile long *)HZ_200;
+}
+
+static int have_ssystem;
+
+static long ticks(void)
+{
+    if (have_ssystem)
+        return Ssystem(S_GETLVAL, HZ_200, 0);
+    return Supexec(read_hz_200);
+}
+
+/* Print a decimal number, right-aligned in width columns */
+static void print_num(unsigned long n, int width)
+{
+    char buf[12];
+    char *p = buf + sizeof(buf) - 1;
+
+    *p = '\0';
+    do {
+        *--p = '0' + (n % 10);
+        n /= 10;
+    } while (n);
+    while (width-- > (buf + sizeof(buf) - 1 - p))
+        Cconout(' ');
+    conws(p);
+}
+
+
+/*
+ * The benchmark cases.  setup() selects the attributes once, op() is
+ * the timed call; n counts the calls, for the cases that vary from one
+ * call to the next.
+ */
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*op)(long n);
+} BENCH;
+
+static void setup_replace(void)
+{
+    vswr_mode(1);
+    vsf_interior(1);            /* solid */
+    vsf_color(1);
+    vsf_perimeter(0);
+    vsl_type(1);
+    vsl_color(1);
+    vst_color(1);
+    vs_clip(0, 0, 0, 0, 0);
+}
+
+static void setup_xor(void)
+{
+    setup_replace();
+    vswr_mode(3);
+}
+
+static void setup_pattern_trans(void)
+{
+    setup_replace();
+    vswr_mode(2);
+    vsf_interior(3);            /* hatch */
+    vsf_style(3);
+}
+
+static void bar_small(long n)
+{
+    rect(16, 16, 31, 31);
+    vdi(11, 2, 0, 1);
+}
+
+static void bar_large(long n)
+{
+    rect(16, 16, 271, 143);
+    vdi(11, 2, 0, 1);
+}
+
+static void gtext(long n)
+{
+    static const char s[] = "The quick brown fox jumps over";
+    int i;
+
+    for (i = 0; s[i]; i++)
+        intin[i] = s[i];
+    ptsin[0] = 16;
+    ptsin[1] = 64;
+    vdi(8, 1, i, 0);
+}
+
+static void cpyfm(short mode, short w, short h)
+{
+    contrl.ptr1 = &screen;
+    contrl.ptr2 = &screen;
+    rect(16, 16, 16 + w - 1, 16 + h - 1);
+    ptsin[4] = 40;
+    ptsin[5] = 24;
+    ptsin[6] = 40 + w - 1;
+    ptsin[7] = 24 + h - 1;
+    intin[0] = mode;
+    vdi(109, 4, 1, 0);
+}
+
+static void cpyfm_small(long n)    { cpyfm(3, 16, 16); }   /* S_ONLY */
+static void cpyfm_large(long n)    { cpyfm(3, 256, 128); }
+static void cpyfm_large_xor(long n) { cpyfm(6, 256, 128); } /* S_XOR_D */
+
+static void rtcopy(short mode)
+{
+    contrl.ptr1 = &icon;
+    contrl.ptr2 = &screen;
+    rect(0, 0, 63, 63);
+    ptsin[4] = 19;              /* deliberately not word aligned */
+    ptsin[5] = 40;
+    ptsin[6] = 19 + 63;
+    ptsin[7] = 40 + 63;
+    intin[0] = mode;
+    intin[1] = 1;
+    intin[2] = 0;
+    vdi(121, 4, 3, 0);
+}
+
+static void rtcopy_replace(long n) { rtcopy(1); }
+static void rtcopy_trans(long n)   { rtcopy(2); }
+
+static void pline(short x1, short y1, short x2, short y2)
+{
+    rect(x1, y1, x2, y2);
+    vdi(6, 2, 0, 0);
+}
+
+static void pline_horiz(long n)   { pline(16, 100, 271, 100); }
+static void pline_diag(long n)    { pline(16, 16, 216, 166); }
+
+static void setup_styled_xor(void)
+{
+    setup_xor();
+    vsl_type(3);                /* dotted */
+}
+
+static void fillarea_tri(long n)
+{
+    ptsin[0] = 16;  ptsin[1] = 16;
+    ptsin[2] = 216; ptsin[3] = 40;
+    ptsin[4] = 60;  ptsin[5] = 166;
+    vdi(9, 3, 0, 0);
+}
+
+static void fillarea_star(long n)
+{
+    static const short star[] = {
+        116, 16,  138, 76, 206, 76, 152, 114, 172, 176,
+        116, 140, 60, 176, 80, 114, 26, 76, 94, 76
+    };
+    int i;
+
+    for (i = 0; i < 20; i++)
+        ptsin[i] = star[i];
+    vdi(9, 10, 0, 0);
+}
+
+/*
+ * Seed colour mode (colour index -1) inside a clip rectangle: every
+ * call floods the whole 128x96 clip area, which is a single colour,
+ * with the other colour, so there is the same work to do every time.
+ */
+static void setup_contour(void)
+{
+    setup_replace();
+    vsf_color(0);
+    rect(16, 16, 143, 111);
+    vdi(11, 2, 0, 1);
+    vs_clip(1, 16, 16, 143, 111);
+}
+
+static void contourfill(long n)
+{
+    /* the area is colour 0 on the first call, so start with colour 1 */
+    vsf_color((n & 1) ^ 1);
+    ptsin[0] = 80;
+    ptsin[1] = 64;
+    intin[0] = -1;
+    vdi(103, 1, 1, 0);
+}
+
+static const BENCH benches[] = {
+    { "v_bar 16x16 replace      ", setup_replace, bar_small },
+    { "v_bar 256x128 replace    ", setup_replace, bar_large },
+    { "v_bar 256x128 xor        ", setup_xor, bar_large },
+    { "v_bar 256x128 hatch trans", setup_pattern_trans, bar_large },
+    { "v_gtext 30 chars replace ", setup_replace, gtext },
+    { "v_gtext 30 chars xor     ", setup_xor, gtext },
+    { "vro_cpyfm 16x16 S_ONLY   ", setup_replace, cpyfm_small },
+    { "vro_cpyfm 256x128 S_ONLY ", setup_replace, cpyfm_large },
+    { "vro_cpyfm 256x128 S_XOR_D", setup_replace, cpyfm_large_xor },
+    { "vrt_cpyfm 64x64 replace  ", setup_replace, rtcopy_replace },
+    { "vrt_cpyfm 64x64 trans    ", setup_replace, rtcopy_trans },
+    { "v_pline 256 horiz replace", setup_replace, pline_horiz },
+    { "v_pline 200x150 replace  ", setup_replace, pline_diag },
+    { "v_pline 200x150 dot xor  ", setup_styled_xor, pline_diag },
+    { "v_fillarea triangle      ", setup_replace, fillarea_tri },
+    { "v_fillarea star xor      ", setup_xor, fillarea_star },
+    { "v_contourfill 128x96     ", setup_contour, contourfill },
+};
+
+/* Returns the calls per second of b */
+static long run_bench(const BENCH *b)
+{
+    long start, end, n = 0;
+
+    b->setup();
+    start = ticks();
+    while ((end = ticks()) == start)    /* sync to a tick boundary */
+        ;
+    start = end;
+    do {
+        b->op(n++);
+    } while ((end = ticks()) - start < BENCH_TICKS);
+
+    return n * 200 / (end - start);
+}
+
+static int open_vwk(void)
+{
+    int i;
+
+    for (i = 0; i < 10; i++)
+        intin[i] = 1;
+    intin[10] = 2;              /* raster coordinates */
+    handle = 1;                 /* the physical workstation */
+    vdi(100, 0, 11, 0);
+    handle = contrl.handle;
+    if (handle <= 0)
+        return 0;
+    scr_w = intout[0] + 1;
+    scr_h = intout[1] + 1;
+
+    set1(102, 1);               /* vq_extnd(): the number of planes */
+    planes = intout[4];
+
+    /* a checkerboard icon, so that both mask polarities occur */
+    for (i = 0; i < 64*4; i++)
+        icon_data[i] = ((i >> 2) & 8) ? 0xff00 : 0x00ff;
+    icon.fd_addr = icon_data;
+    icon.fd_w = 64;
+    icon.fd_h = 64;
+    icon.fd_wdwidth = 4;
+    icon.fd_nplanes = 1;
+    return 1;
+}
+
+void test_vdi_bench(void)
+{
+    unsigned int i;
+    long rate, ok = 1;
+
+    have_ssystem = (Ssystem(S_INQUIRE, 0, 0) == 0);
+
+    if (!open_vwk()) {
+        ptest_begin("vdi_bench");
+        ptest_fail("v_opnvwk() failed");
+        return;
+    }
+
+    conws("  vdi_bench: ");
+    print_num(scr_w, 0);
+    conws("x");
+    print_num(scr_h, 0);
+    conws(", ");
+    print_num(planes, 0);
+    conws(planes == 16 ? " planes (RGB565)\r\n" :
+          planes == 32 ? " planes (XRGB8888)\r\n" : " planes (planar)\r\n");
+
+    vdi(123, 0, 0, 0);          /* v_hide_c() */
+    for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        rate = run_bench(&benches[i]);
+        if (rate <= 0)
+            ok = 0;
+        conws("    ");
+        conws(benches[i].name);
+        print_num(rate, 9);
+        conws(" calls/s\r\n");
+    }
+    set1(122, 0);               /* v_show_c() */
+    vdi(101, 0, 0, 0);          /* v_clsvwk() */
+
+    ptest_begin("vdi_bench");
+    ptest_assert_msg(ok, "a benchmark case made no progress");
+    ptest_pass();
+}
@@ -2,12 +2,12 @@
 # util/build.mk - objects making up the shared utility routines
 #
 
-obj-y += doprintf.o intmath.o langs.o memmove.o string.o miscasm.o nls.o \
-	 setjmp.o
+obj-y += doprintf.o intmath.o langs.o memmove.o memset.o string.o miscasm.o \
+	 nls.o setjmp.o
 
 obj-$(CONF_WITH_VIRTIO) += virtio.o
 
-obj-$(ARCH_M68K) += memset.o stringasm.o
+obj-$(ARCH_M68K) += stringasm.o
 
 # The routines below are only used by the AES and by EmuDesk.
 ifdef CONF_WITH_AES
@@ -32,13 +32,17 @@
 static ULONG last_sprite_checksum;
 static ULONG pointer_image[16][16];
 
+/* cursor state last passed to the firmware */
+static BOOL cursor_enabled;
+static WORD cursor_x, cursor_y;
+
 static ULONG raspi_cur_calc_checksum(Mcdb *sprite);
 static BOOL raspi_hw_cur_set_sprite(Mcdb *sprite);
+static BOOL raspi_hw_cur_set_state(BOOL enable, WORD x, WORD y);
 
 BOOL raspi_hw_cur_display(Mcdb *sprite, WORD x, WORD y)
 {
     ULONG checksum = raspi_cur_calc_checksum(sprite);
-    prop_tag_cursor_state_t tag;
 
     if (checksum != last_sprite_checksum)
     {
@@ -46,11 +50,35 @@ BOOL raspi_hw_cur_display(Mcdb *sprite, WORD x, WORD y)
             return FALSE;
         last_sprite_checksum = checksum;
     }
-    tag.enable = 1;
+    else if (cursor_enabled && x == cursor_x && y == cursor_y)
+        return TRUE;    /* already showing this: spare the mailbox call */
+
+    return raspi_hw_cur_set_state(TRUE, x, y);
+}
+
+BOOL raspi_hw_cur_hide(void)
+{
+    if (!cursor_enabled)
+        return TRUE;
+
+    return raspi_hw_cur_set_state(FALSE, cursor_x, cursor_y);
+}
+
+static BOOL raspi_hw_cur_set_state(BOOL enable, WORD x, WORD y)
+{
+    prop_tag_cursor_state_t tag;
+
+    tag.enable = enable;
     tag.pos_x = x;
     tag.pos_y = y;
     tag.flags = CURSOR_FLAGS_FB_COORDS;
-    return raspi_prop_get_tag(PROPTAG_SET_CURSOR_STATE, &tag, sizeof(prop_tag_cursor_state_t), 4*4);
+    if (!raspi_prop_get_tag(PROPTAG_SET_CURSOR_STATE, &tag, sizeof(prop_tag_cursor_state_t), 4*4))
+        return FALSE;
+
+    cursor_enabled = enable;
+    cursor_x = x;
+    cursor_y = y;
+    return TRUE;
 }
 
 
@@ -18,5 +18,12 @@
  */
 BOOL raspi_hw_cur_display(Mcdb *sprite, WORD x, WORD y);
 
+/*
+ * Switches the hardware cursor off.  Returns FALSE if the firmware call
+ * fails.  Both calls skip the mailbox round trip when the cursor is
+ * already in the requested state.
+ */
+BOOL raspi_hw_cur_hide(void);
+
 #   endif /* MACHINE_RPI */
 #endif /* RASPI_MOUSE_H */
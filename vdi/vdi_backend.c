@@ -397,26 +397,26 @@ static UWORD default_draw_line(const Line *line, WORD wrt_mode, UWORD color, UWO
     return linemask;
 }
 
-static WORD default_search_right(const VwkClip *clip, WORD x, WORD y, UWORD search_col)
+static BOOL default_scan_run(const VwkClip *clip, WORD x, WORD y, UWORD search_col,
+                             WORD *xleft, WORD *xright)
 {
     const vdi_backend_ops *ops = vdi_screen_backend();
+    const BOOL match = (ops->get_pixel(x, y) == search_col);
+    WORD i;
 
-    while (x++ < clip->xmx_clip) {
-        if (ops->get_pixel(x, y) != search_col)
+    for (i = x; i < clip->xmx_clip; i++) {
+        if ((ops->get_pixel(i + 1, y) == search_col) != match)
             break;
     }
-    return x - 1;       /* output x coord -1 to endxright. */
-}
+    *xright = i;
 
-static WORD default_search_left(const VwkClip *clip, WORD x, WORD y, UWORD search_col)
-{
-    const vdi_backend_ops *ops = vdi_screen_backend();
-
-    while (x-- > clip->xmn_clip) {
-        if (ops->get_pixel(x, y) != search_col)
+    for (i = x; i > clip->xmn_clip; i--) {
+        if ((ops->get_pixel(i - 1, y) == search_col) != match)
             break;
     }
-    return x + 1;       /* output x coord + 1 to endxleft. */
+    *xleft = i;
+
+    return match;
 }
 
 void vdi_backend_ops_validate(const vdi_backend_ops *ops)
@@ -435,8 +435,7 @@ void vdi_backend_ops_init(vdi_backend_ops *ops)
     if (!ops->text_blit) ops->text_blit = default_text_blit;
     if (!ops->raster_copy) ops->raster_copy = default_raster_copy;
     if (!ops->draw_line) ops->draw_line = default_draw_line;
-    if (!ops->search_right) ops->search_right = default_search_right;
-    if (!ops->search_left) ops->search_left = default_search_left;
+    if (!ops->scan_run) ops->scan_run = default_scan_run;
 
     vdi_backend_ops_validate(ops);
 }
@@ -74,15 +74,17 @@ typedef struct vdi_backend_ops {
     UWORD (*draw_line)(const Line *line, WORD wrt_mode, UWORD color, UWORD linemask);
 
     /*
-     * Scan right/left from (x,y) along a horizontal line for the last
-     * pixel matching search_col (a MAP_COL-mapped hardware palette index,
-     * like get_pixel()'s return value) before the first mismatch or the
-     * clip edge -- used by contourfill()'s seed-fill scan (see end_pts()
-     * in vdi_fill.c).  A backend that does not provide its own gets the
-     * generic default (see vdi_backend_ops_init()).
+     * Find the horizontal run through (x,y), within the clip edges, of
+     * pixels that all match search_col (a MAP_COL-mapped hardware palette
+     * index, like get_pixel()'s return value) or all differ from it, and
+     * store its ends in xleft/xright; returns whether (x,y) matches.
+     * Used by contourfill()'s span fill (see end_pts() in vdi_fill.c),
+     * which so gets a whole section of a row out of a single call.  A
+     * backend that does not provide its own gets the generic default
+     * (see vdi_backend_ops_init()).
      */
-    WORD (*search_right)(const VwkClip *clip, WORD x, WORD y, UWORD search_col);
-    WORD (*search_left)(const VwkClip *clip, WORD x, WORD y, UWORD search_col);
+    BOOL (*scan_run)(const VwkClip *clip, WORD x, WORD y, UWORD search_col,
+                     WORD *xleft, WORD *xright);
     /*
      * Bytes per packed pixel (2 for RGB565, 4 for XRGB8888).  Used by
      * vdi_backend_ops_init()'s generic defaults to compute a raw XOR mask
@@ -226,6 +228,12 @@ static inline BOOL vdi_screen_is_truecolor(void)
 #if CONF_WITH_VDI_BACKEND_TRUECOLOR
 ULONG vdi_truecolor_pixel_for_index(WORD index);
 
+/*
+ * The reverse: the lowest hardware palette index of vwk whose packed
+ * pixel value is pixel, or 0 if there is none.  Used by get_pixel().
+ */
+UWORD vdi_truecolor_index_for_pixel(Vwk *vwk, ULONG pixel);
+
 /*
  * vs_color()/vq_color() pseudo-palette access for the truecolor backend
  * (issue #89). Genuinely per-workstation (see the tc_palette comment on
@@ -63,8 +63,7 @@ const vdi_backend_ops default_planar_backend_ops = {
     planar_text_blit,
     planar_raster_copy,
     planar_draw_line,
-    planar_search_right,
-    planar_search_left,
+    planar_scan_run,
     2,                          /* pixel_size */
 };
 
@@ -11,6 +11,7 @@
 #include "config.h"
 #include "portab.h"
 #include "asm.h"
+#include "string.h"
 #include "../bios/lineavars.h"
 #include "../bios/tosvars.h"
 #include "vdi_defs.h"
@@ -173,6 +174,8 @@ void vdi_truecolor_init_palette(Vwk *vwk)
         }
     }
 
+    vwk->tc_inverse_valid = FALSE;
+
     npens = linea_vars.DEV_TAB[13];
     if (npens < 0)
         npens = 0;
@@ -187,7 +190,7 @@ void vdi_truecolor_init_palette(Vwk *vwk)
 /*
  * The workstation whose pseudo-palette the drawing primitives below
  * (get_pixel/put_pixel/fill_rect/text_blit/raster_copy/draw_line/
- * search_left/search_right) translate indices through -- none of them
+ * scan_run) translate indices through -- none of them
  * take a Vwk*, so vdi_main.c's screen() dispatcher is the sole writer,
  * via vdi_backend_set_active_vwk(), once per VDI call, with the Vwk
  * resolved for that call's handle (or the physical workstation for
@@ -303,6 +306,65 @@ ULONG vdi_truecolor_pixel_for_index(WORD index)
     return physical_vwk_seeded()->tc_palette[index];
 }
 
+/*
+ * Pixel value -> palette index, through the tc_inverse[] hash of vwk.
+ *
+ * get_pixel() is called once per pixel by v_get_pixel() and for the seed
+ * of every contour fill, and used to search all 256 entries of the
+ * palette for a match.  The hash is (re)built lazily on the first lookup
+ * after the palette changed: vs_color() calls tend to come in batches,
+ * which would otherwise rebuild it once per call.  Indices are inserted
+ * in ascending order and only if their value is not present yet, so the
+ * lowest index wins as with the linear search.
+ */
+static UWORD inverse_slot(ULONG pixel)
+{
+    return (UWORD)((pixel ^ (pixel >> 7) ^ (pixel >> 16)) & (TC_INVERSE_SIZE - 1));
+}
+
+static void build_inverse(Vwk *vwk)
+{
+    WORD i;
+
+    bzero(vwk->tc_inverse, sizeof(vwk->tc_inverse));
+
+    for (i = 0; i < 256; i++) {
+        ULONG pixel = vwk->tc_palette[i];
+        UWORD slot = inverse_slot(pixel);
+
+        for (;;) {
+            UWORD entry = vwk->tc_inverse[slot];
+
+            if (entry == 0) {
+                vwk->tc_inverse[slot] = i + 1;
+                break;
+            }
+            if (vwk->tc_palette[entry - 1] == pixel)
+                break;                  /* a lower index has this value */
+            slot = (slot + 1) & (TC_INVERSE_SIZE - 1);
+        }
+    }
+    vwk->tc_inverse_valid = TRUE;
+}
+
+UWORD vdi_truecolor_index_for_pixel(Vwk *vwk, ULONG pixel)
+{
+    UWORD slot = inverse_slot(pixel);
+    UWORD entry;
+
+    if (!vwk->tc_inverse_valid)
+        build_inverse(vwk);
+
+    /* at most 256 of the slots are used, so there is always an empty one */
+    while ((entry = vwk->tc_inverse[slot]) != 0) {
+        if (vwk->tc_palette[entry - 1] == pixel)
+            return entry - 1;
+        slot = (slot + 1) & (TC_INVERSE_SIZE - 1);
+    }
+
+    return 0;
+}
+
 /*
  * VDI-scale (0-1000 per component) <-> RGB565 conversion for
  * vs_color()/vq_color() (issue #89). Uses rounding division rather than
@@ -376,6 +438,7 @@ void vdi_truecolor_set_color(Vwk *vwk, WORD index, WORD r, WORD g, WORD b)
     } else {
         vwk->tc_palette[index] = rgb565_from_vdi(r, g, b);
     }
+    vwk->tc_inverse_valid = FALSE;
 }
 
 void vdi_truecolor_get_color(const Vwk *vwk, WORD index, WORD *r, WORD *g, WORD *b)
@@ -438,14 +501,13 @@ vdi_backend_ops packed_truecolor_backend_ops = {
     /* The optional slots are left NULL so vdi_backend_ops_init() fills them
      * with the generic defaults -- this exercises issue #138's defaults
      * against the real RGB565 framebuffer. Never in production images. */
-    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL,
 #else
     tc_fill_rect,
     tc_text_blit,
     tc_raster_copy,
     tc_draw_line,
-    tc_search_right,
-    tc_search_left,
+    tc_scan_run,
 #endif
     2,                          /* pixel_size */
 };
@@ -461,8 +523,7 @@ UWORD truecolor_get_pixel(WORD x, WORD y) { return tc_get_pixel(x, y); }
 void truecolor_put_pixel(WORD x, WORD y, UWORD color) { tc_put_pixel(x, y, color); }
 void truecolor_fill_rect(const VwkAttrib *attr, const Rect *rect) { tc_fill_rect(attr, rect); }
 UWORD truecolor_draw_line(const Line *line, WORD wrt_mode, UWORD color, UWORD linemask) { return tc_draw_line(line, wrt_mode, color, linemask); }
-WORD truecolor_search_right(const VwkClip *clip, WORD x, WORD y, UWORD search_col) { return tc_search_right(clip, x, y, search_col); }
-WORD truecolor_search_left(const VwkClip *clip, WORD x, WORD y, UWORD search_col) { return tc_search_left(clip, x, y, search_col); }
+BOOL truecolor_scan_run(const VwkClip *clip, WORD x, WORD y, UWORD search_col, WORD *xleft, WORD *xright) { return tc_scan_run(clip, x, y, search_col, xleft, xright); }
 void truecolor_raster_copy(struct raster_t *raster, struct blit_frame *info) { tc_raster_copy(raster, info); }
 void truecolor_text_blit(LOCALVARS *vars) { tc_text_blit(vars); }
 #endif
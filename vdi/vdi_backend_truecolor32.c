@@ -17,6 +17,7 @@
 #include "config.h"
 #include "portab.h"
 #include "asm.h"
+#include "string.h"
 #include "../bios/lineavars.h"
 #include "../bios/tosvars.h"
 #include "vdi_defs.h"
@@ -59,14 +60,13 @@ vdi_backend_ops packed_truecolor32_backend_ops = {
     /* The optional slots are left NULL so vdi_backend_ops_init() fills them
      * with the generic defaults -- same sparse behavior as the 16bpp RGB565
      * wrapper (see vdi_backend_truecolor.c). */
-    NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL,
 #else
     tc_fill_rect,
     tc_text_blit,
     tc_raster_copy,
     tc_draw_line,
-    tc_search_right,
-    tc_search_left,
+    tc_scan_run,
 #endif
     4,                          /* pixel_size */
 };
@@ -23,13 +23,19 @@
  * hardware palette index through tc_pixel_for_index() below, which reads
  * the (widened) tc_palette[] that the wrapper seeds with the active
  * format's packed value -- so this code is format-agnostic.
+ *
+ * The pixel loops of the write-mode dependent primitives are themselves a
+ * second-level template, vdi_backend_truecolor_wrmode.c, instantiated
+ * below once per write mode.  The tc_* entry points here only resolve
+ * colours and pick the instantiation for the call's write mode.
  */
 
 #if CONF_VDI_SPARSE_TABLE
 /* Unreferenced in sparse builds, where the wrapper's ops table leaves the
- * optional slots NULL (see vdi_backend_truecolor.c).  The two helpers
- * below (get_src_word, apply_raster_op) are only called by the optional-slot
- * functions, so they become unreferenced there too. */
+ * optional slots NULL (see vdi_backend_truecolor.c).  The helpers below
+ * (get_src_word, apply_raster_op and the write-mode instantiations) are
+ * only called by the optional-slot functions, so they become unreferenced
+ * there too. */
 #define TC_SPARSE_UNUSED __attribute__((unused))
 #else
 #define TC_SPARSE_UNUSED
@@ -67,22 +73,17 @@ static PIXEL *tc_get_start_addr(WORD x, WORD y)
 static UWORD tc_get_pixel(WORD x, WORD y)
 {
     PIXEL raw = *tc_get_start_addr(x, y);
-    const ULONG *palette = vdi_backend_active_vwk()->tc_palette;
-    WORD i;
 
     /*
      * Callers expect a hardware palette register index back (see the
-     * comment on default_prgb_palette[] above), not a 0-15 VDI pen
-     * number, so this has to search the full 256-entry space to match.
-     * The stored palette values are ULONGs now (the active format's
-     * packed pixel); for RGB565 the upper bits are zero.
+     * comment on default_prgb_palette[] in vdi_backend_truecolor.c), not
+     * a 0-15 VDI pen number, so this matches against the full 256-entry
+     * space.  The stored palette values are ULONGs (the active format's
+     * packed pixel); for RGB565 the upper bits are zero.  A pixel that is
+     * not one of the active palette's 256 gives index 0 (white), the
+     * closest we can do without guessing.
      */
-    for (i = 0; i < 256; i++) {
-        if (palette[i] == (ULONG)raw)
-            return (UWORD)i;
-    }
-
-    return 0;   /* not one of the active palette's 256 -- index 0 is white, the closest we can do without guessing */
+    return vdi_truecolor_index_for_pixel(vdi_backend_active_vwk(), (ULONG)raw);
 }
 
 static void tc_put_pixel(WORD x, WORD y, UWORD color)
@@ -92,57 +93,6 @@ static void tc_put_pixel(WORD x, WORD y, UWORD color)
     *addr = tc_pixel_for_index((WORD)color);
 }
 
-static void TC_SPARSE_UNUSED tc_fill_rect(const VwkAttrib *attr, const Rect *rect)
-{
-    const UWORD patmsk = attr->patmsk;
-    PIXEL pixel = tc_pixel_for_index((WORD)attr->color);
-    UBYTE *row = (UBYTE *)tc_get_start_addr(0, rect->y1);
-    WORD x, y, i;
-
-    for (y = rect->y1; y <= rect->y2; y++, row += linea_vars.v_lin_wr) {
-        WORD patind = patmsk & y;   /* starting pattern */
-        UWORD pattern = attr->patptr[patind];
-        PIXEL *dst = (PIXEL *)row;
-
-        for (x = rect->x1, i = 0; x <= rect->x2; x++, i++) {
-            BOOL set = (pattern & ((1<<15)>>(i & 15))) != 0;
-
-            switch (attr->wrt_mode) {
-            case 3:                 /* erase (reverse transparent) mode */
-                if (!set)
-                    dst[x] = pixel;
-                break;
-            case 2:                 /* xor mode */
-                /*
-                 * The planar path XORs the pattern into every plane
-                 * unconditionally -- a full bitwise invert, independent
-                 * of attr->color (this is how the AES draws rubber-band
-                 * selection boxes). XOR-ing in the mapped foreground
-                 * pixel instead is not equivalent: it's a no-op for any
-                 * pen mapping to 0x0000, and produces an arbitrary
-                 * colour rather than an inversion for anything else. So
-                 * this ignores attr->color/pixel entirely and inverts,
-                 * matching planar's actual semantics.
-                 */
-                if (set)
-                    dst[x] ^= (PIXEL)-1;
-                break;
-            case 1:                 /* transparent mode */
-                if (set)
-                    dst[x] = pixel;
-                break;
-            default:                /* replace mode */
-                /*
-                 * Unset pattern bits paint pen 0 (white by default),
-                 * matching the planar path, which writes color index 0
-                 * for unset bits -- not raw RGB565 0 (black).
-                 */
-                dst[x] = set ? pixel : tc_pixel_for_index(0);
-            }
-        }
-    }
-}
-
 /*
  * fetch the source word in big-endian (Motorola font) byte order
  *
@@ -159,6 +109,105 @@ static UWORD TC_SPARSE_UNUSED get_src_word(const UBYTE *p)
     return (UWORD)(((UWORD)p[0] << 8) | (UWORD)p[1]);
 }
 
+/*
+ * Write n copies of pix, or invert n pixels, from p rightwards: the run
+ * primitives of solid fills and solid lines.  At 16bpp, runs long enough
+ * to be worth it are written two pixels per 32-bit store once p is
+ * aligned.
+ */
+static void TC_SPARSE_UNUSED tc_store_span(PIXEL *p, WORD n, PIXEL pix)
+{
+#if PIXEL_SIZE == 2
+    if (n >= 4) {
+        ULONG pair = ((ULONG)pix << 16) | pix;
+        ULONG_ALIAS *q;
+
+        if ((ULONG)p & 2) {
+            *p++ = pix;
+            n--;
+        }
+        for (q = (ULONG_ALIAS *)p; n >= 2; n -= 2)
+            *q++ = pair;
+        p = (PIXEL *)q;
+    }
+#endif
+    while (n-- > 0)
+        *p++ = pix;
+}
+
+static void TC_SPARSE_UNUSED tc_invert_span(PIXEL *p, WORD n)
+{
+#if PIXEL_SIZE == 2
+    if (n >= 4) {
+        ULONG_ALIAS *q;
+
+        if ((ULONG)p & 2) {
+            *p = (PIXEL)~*p;
+            p++;
+            n--;
+        }
+        for (q = (ULONG_ALIAS *)p; n >= 2; n -= 2, q++)
+            *q = ~*q;
+        p = (PIXEL *)q;
+    }
+#endif
+    for ( ; n > 0; n--, p++)
+        *p = (PIXEL)~*p;
+}
+
+#define TC_WRMODE WM_REPLACE
+#define TC_WM(name) name##_replace
+#include "vdi_backend_truecolor_wrmode.c"
+#undef TC_WM
+#undef TC_WRMODE
+
+#define TC_WRMODE WM_TRANS
+#define TC_WM(name) name##_trans
+#include "vdi_backend_truecolor_wrmode.c"
+#undef TC_WM
+#undef TC_WRMODE
+
+#define TC_WRMODE WM_XOR
+#define TC_WM(name) name##_xor
+#include "vdi_backend_truecolor_wrmode.c"
+#undef TC_WM
+#undef TC_WRMODE
+
+#define TC_WRMODE WM_ERASE
+#define TC_WM(name) name##_erase
+#include "vdi_backend_truecolor_wrmode.c"
+#undef TC_WM
+#undef TC_WRMODE
+
+/*
+ * truecolor fill_rect: fill a rectangle with the current fill pattern.
+ *
+ * Unset pattern bits paint pen 0 (white by default) in replace mode,
+ * matching the planar path, which writes color index 0 for unset bits --
+ * not raw pixel 0 (black).  XOR mode ignores attr->color and inverts:
+ * the planar path XORs the pattern into every plane unconditionally,
+ * which is how the AES draws rubber-band selection boxes.
+ */
+static void TC_SPARSE_UNUSED tc_fill_rect(const VwkAttrib *attr, const Rect *rect)
+{
+    PIXEL pixel = tc_pixel_for_index((WORD)attr->color);
+
+    switch (attr->wrt_mode) {
+    case WM_ERASE:
+        tc_fill_erase(attr, rect, pixel, pixel);
+        break;
+    case WM_XOR:
+        tc_fill_xor(attr, rect, pixel, pixel);
+        break;
+    case WM_TRANS:
+        tc_fill_trans(attr, rect, pixel, pixel);
+        break;
+    default:
+        tc_fill_replace(attr, rect, pixel, tc_pixel_for_index(0));
+        break;
+    }
+}
+
 /*
  * truecolor text blit: output the current glyph to a packed truecolor
  * screen (RGB565 or XRGB8888, per the instantiation)
@@ -170,12 +219,10 @@ static UWORD TC_SPARSE_UNUSED get_src_word(const UBYTE *p)
  */
 static void TC_SPARSE_UNUSED tc_text_blit(LOCALVARS *vars)
 {
-    UBYTE *p;
-    PIXEL *q;
     UBYTE *src, *dst;
     PIXEL fgcol, bgcol;
-    UWORD src_mask, mask, skew_mask;
-    WORD h, w, skew, skew_start;
+    UWORD src_mask, skew_mask;
+    WORD skew, skew_start;
 
     /*
      * set skew-related values
@@ -254,131 +301,20 @@ static void TC_SPARSE_UNUSED tc_text_blit(LOCALVARS *vars)
      * are theoretically possible.  however, at this time we do not support them.
      */
     default:    /* WM_REPLACE */
-        for (h = vars->height; h > 0; h--, src += vars->s_next, dst += vars->d_next)
-        {
-            p = src;
-            q = (PIXEL *)dst;
-            for (w = vars->width, mask = src_mask; w > 0; w--)
-            {
-                *q++ = (get_src_word(p) & mask) ? fgcol : bgcol;
-                rorw1(mask);
-                if (mask == 0x8000)
-                    p += 2;
-            }
-            /*
-             * special handling for skewed text: since the character cells
-             * are effectively slanted, we must shift the starting position
-             * of a cell rightwards as we go up the character.
-             */
-            if (skew && (h <= skew_start))  /* OK to shift box for skewed text? */
-            {
-                rolw1(skew_mask);
-                if (skew_mask & 0x8000)
-                {
-                    rorw1(src_mask);
-                    if (src_mask == 0x8000)
-                        src++;
-                    dst += PIXEL_SIZE;
-                }
-            }
-        }
+        tc_text_replace(vars, src, dst, src_mask, skew, skew_mask, skew_start, fgcol, bgcol);
         break;
     case WM_TRANS:
-        for (h = vars->height; h > 0; h--, src += vars->s_next, dst += vars->d_next)
-        {
-            p = src;
-            q = (PIXEL *)dst;
-            for (w = vars->width, mask = src_mask; w > 0; w--)
-            {
-                if (get_src_word(p) & mask)
-                    *q = fgcol;
-                q++;
-                rorw1(mask);
-                if (mask == 0x8000)
-                    p += 2;
-            }
-            /*
-             * see comments for WM_REPLACE (above) for an explanation of
-             * the following
-             */
-            if (skew && (h <= skew_start))  /* OK to shift box for skewed text? */
-            {
-                rolw1(skew_mask);
-                if (skew_mask & 0x8000)
-                {
-                    rorw1(src_mask);
-                    if (src_mask == 0x8000)
-                        src++;
-                    dst += PIXEL_SIZE;
-                }
-            }
-        }
+        tc_text_trans(vars, src, dst, src_mask, skew, skew_mask, skew_start, fgcol, bgcol);
         break;
     case WM_XOR:
-        for (h = vars->height; h > 0; h--, src += vars->s_next, dst += vars->d_next)
-        {
-            p = src;
-            q = (PIXEL *)dst;
-            for (w = vars->width, mask = src_mask; w > 0; w--)
-            {
-                if (get_src_word(p) & mask)
-                    *q = (PIXEL)~*q;
-                q++;
-                rorw1(mask);
-                if (mask == 0x8000)
-                    p += 2;
-            }
-            /*
-             * see comments for WM_REPLACE (above) for an explanation of
-             * the following
-             */
-            if (skew && (h <= skew_start))  /* OK to shift box for skewed text? */
-            {
-                rolw1(skew_mask);
-                if (skew_mask & 0x8000)
-                {
-                    rorw1(src_mask);
-                    if (src_mask == 0x8000)
-                        src++;
-                    dst += PIXEL_SIZE;
-                }
-            }
-        }
+        tc_text_xor(vars, src, dst, src_mask, skew, skew_mask, skew_start, fgcol, bgcol);
         break;
     case WM_ERASE:
-        for (h = vars->height; h > 0; h--, src += vars->s_next, dst += vars->d_next)
-        {
-            p = src;
-            q = (PIXEL *)dst;
-            for (w = vars->width, mask = src_mask; w > 0; w--)
-            {
-                /*
-                 * behaviour here differs from TOS 4.04 - for further info,
-                 * see the comments in direct_screen_blit16()
-                 */
-                if (!(get_src_word(p) & mask))
-                    *q = fgcol;
-                q++;
-                rorw1(mask);
-                if (mask == 0x8000)
-                    p += 2;
-            }
-            /*
-             * see comments for WM_REPLACE (above) for an explanation of
-             * the following
-             */
-            if (skew && (h <= skew_start))  /* OK to shift box for skewed text? */
-            {
-                rolw1(skew_mask);
-                if (skew_mask & 0x8000)
-                {
-                    rorw1(src_mask);
-                    if (src_mask == 0x8000)
-                        src++;
-                    dst += PIXEL_SIZE;
-                }
-            }
-        }
+        /*
+         * behaviour here differs from TOS 4.04 - for further info,
+         * see the comments in direct_screen_blit16()
+         */
+        tc_text_erase(vars, src, dst, src_mask, skew, skew_mask, skew_start, fgcol, fgcol);
         break;
     }
 }
@@ -446,54 +382,30 @@ static void TC_SPARSE_UNUSED tc_raster_copy(struct raster_t *raster, struct blit
         PIXEL fgpix = tc_pixel_for_index((WORD)raster->fg_col);
         PIXEL bgpix = tc_pixel_for_index((WORD)raster->bg_col);
 
-        for (y = 0; y < info->b_ht; y++) {
-            const UBYTE *srow = (const UBYTE *)info->s_form
-                + (LONG)(info->s_ymin + y) * info->s_nxln;
-            UBYTE *drow = (UBYTE *)info->d_form
-                + (LONG)(info->d_ymin + y) * info->d_nxln;
-            const UBYTE *p = srow + (LONG)(info->s_xmin >> 4) * info->s_nxwd;
-            PIXEL *q = (PIXEL *)(drow + (LONG)info->d_xmin * info->d_nxwd);
-            UWORD mask = 0x8000 >> (info->s_xmin & 0x0f);
-            WORD x;
-
-            for (x = 0; x < info->b_wd; x++) {
-                /*
-                 * Icon mask/data words (unlike font glyph bytes -- see
-                 * get_src_word() above) are stored as WORD *value*
-                 * arrays by the resource compiler (tools/erd.c), which
-                 * the target compiler already lays out in its native
-                 * byte order. A native dereference here matches that,
-                 * and matches how the planar blitter reads the same
-                 * MFDB-sourced words (GetMemW() in vdi_raster.c);
-                 * get_src_word()'s manual big-endian byte reassembly
-                 * would double-handle the byte order and scramble every
-                 * word on a little-endian target.
-                 */
-                BOOL set = (*(const UWORD *)p & mask) != 0;
-
-                switch (raster->mode) {
-                case MD_REPLACE:
-                    *q = set ? fgpix : bgpix;
-                    break;
-                case MD_TRANS:
-                    if (set)
-                        *q = fgpix;
-                    break;
-                case MD_XOR:
-                    if (set)
-                        *q = (PIXEL)~*q;
-                    break;
-                case MD_ERASE:
-                    if (!set)
-                        *q = bgpix;
-                    break;
-                }
-                q++;
-
-                rorw1(mask);
-                if (mask == 0x8000)
-                    p += 2;
-            }
+        /*
+         * Icon mask/data words (unlike font glyph bytes -- see
+         * get_src_word() above) are stored as WORD *value* arrays by the
+         * resource compiler (tools/erd.c), which the target compiler
+         * already lays out in its native byte order. A native
+         * dereference matches that, and matches how the planar blitter
+         * reads the same MFDB-sourced words (GetMemW() in vdi_raster.c);
+         * get_src_word()'s manual big-endian byte reassembly would
+         * double-handle the byte order and scramble every word on a
+         * little-endian target.
+         */
+        switch (raster->mode) {
+        case MD_REPLACE:
+            tc_expand_replace(info, fgpix, bgpix);
+            break;
+        case MD_TRANS:
+            tc_expand_trans(info, fgpix, bgpix);
+            break;
+        case MD_XOR:
+            tc_expand_xor(info, fgpix, bgpix);
+            break;
+        case MD_ERASE:
+            tc_expand_erase(info, fgpix, bgpix);
+            break;
         }
         return;
     }
@@ -527,6 +439,13 @@ static void TC_SPARSE_UNUSED tc_raster_copy(struct raster_t *raster, struct blit
                 + (LONG)(info->d_ymin + row) * info->d_nxln + (LONG)info->d_xmin * info->d_nxwd);
             WORD x;
 
+            /* a plain copy is by far the most common op (window moves,
+             * scrolling); memmove() also handles the overlap within a row */
+            if ((info->op_tab[0] & 0x0f) == BM_S_ONLY) {
+                memmove(drow, srow, (LONG)info->b_wd * PIXEL_SIZE);
+                continue;
+            }
+
             for (x = 0; x < info->b_wd; x++) {
                 WORD col = forward_x ? x : (info->b_wd - 1 - x);
                 drow[col] = apply_raster_op(info->op_tab[0], srow[col], drow[col]);
@@ -541,8 +460,10 @@ static void TC_SPARSE_UNUSED tc_raster_copy(struct raster_t *raster, struct blit
  * lines itself, via fill_rect(), and never calls this for one).
  *
  * A packed screen has no bitplanes to loop over, so this is a single-pass
- * Bresenham writing one whole pixel per step, unlike the planar
- * implementation's per-bitplane loop (planar_draw_line() in vdi_line.c).
+ * Bresenham writing one whole pixel per step (or, for a solid line, one
+ * whole horizontal or vertical run per step, see tc_line_*() in
+ * vdi_backend_truecolor_wrmode.c), unlike the planar implementation's
+ * per-bitplane loop (planar_draw_line() in vdi_line.c).
  * The write-mode semantics are derived directly from that function's
  * per-bitplane logic, composed across a whole pixel instead of one bit
  * per plane:
@@ -561,10 +482,9 @@ static void TC_SPARSE_UNUSED tc_raster_copy(struct raster_t *raster, struct blit
 static UWORD TC_SPARSE_UNUSED tc_draw_line(const Line *line, WORD wrt_mode, UWORD color, UWORD linemask)
 {
     UWORD x1, y1, x2, y2;
-    WORD dx, dy, loopcnt;
+    WORD dx, dy;
     LONG yinc;
     UBYTE *adr;
-    PIXEL fgpix, bg0pix, notpix;
 
     if (line->x2 < line->x1) {
         x1 = line->x2; y1 = line->y2;
@@ -577,10 +497,6 @@ static UWORD TC_SPARSE_UNUSED tc_draw_line(const Line *line, WORD wrt_mode, UWOR
     dx = x2 - x1;
     dy = y2 - y1;
 
-    fgpix = tc_pixel_for_index((WORD)color);
-    bg0pix = tc_pixel_for_index(0);
-    notpix = tc_pixel_for_index((WORD)(~color & 0xff));
-
     if (dy < 0) {
         dy = -dy;
         yinc = -(LONG)linea_vars.v_lin_wr;
@@ -589,85 +505,68 @@ static UWORD TC_SPARSE_UNUSED tc_draw_line(const Line *line, WORD wrt_mode, UWOR
     }
     adr = (UBYTE *)tc_get_start_addr(x1, y1);
 
-    if (dx >= dy) {
-        WORD eps = -dx, e1 = 2*dy, e2 = 2*dx;
-
-        for (loopcnt = dx; loopcnt >= 0; loopcnt--) {
-            PIXEL *p = (PIXEL *)adr;
-
-            rolw1(linemask);
-            switch (wrt_mode) {
-            case 3: if (linemask & 1) *p = notpix; break;
-            case 2: if (linemask & 1) *p ^= (PIXEL)-1; break;
-            case 1: if (linemask & 1) *p = fgpix; break;
-            default: *p = (linemask & 1) ? fgpix : bg0pix; break;
-            }
-            adr += PIXEL_SIZE;
-            eps += e1;
-            if (eps >= 0) {
-                eps -= e2;
-                adr += yinc;
-            }
-        }
-    } else {
-        WORD eps = -dy, e1 = 2*dx, e2 = 2*dy;
-
-        for (loopcnt = dy; loopcnt >= 0; loopcnt--) {
-            PIXEL *p = (PIXEL *)adr;
-
-            rolw1(linemask);
-            switch (wrt_mode) {
-            case 3: if (linemask & 1) *p = notpix; break;
-            case 2: if (linemask & 1) *p ^= (PIXEL)-1; break;
-            case 1: if (linemask & 1) *p = fgpix; break;
-            default: *p = (linemask & 1) ? fgpix : bg0pix; break;
-            }
-            adr += yinc;
-            eps += e1;
-            if (eps >= 0) {
-                eps -= e2;
-                adr += PIXEL_SIZE;
-            }
-        }
+    switch (wrt_mode) {
+    case 3:
+        /* reverse transparent is transparent with the complemented colour */
+        return tc_line_trans(adr, dx, dy, yinc,
+                             tc_pixel_for_index((WORD)(~color & 0xff)), 0, linemask);
+    case 2:
+        return tc_line_xor(adr, dx, dy, yinc, 0, 0, linemask);
+    case 1:
+        return tc_line_trans(adr, dx, dy, yinc,
+                             tc_pixel_for_index((WORD)color), 0, linemask);
+    default:
+        return tc_line_replace(adr, dx, dy, yinc, tc_pixel_for_index((WORD)color),
+                               tc_pixel_for_index(0), linemask);
     }
-
-    return linemask;
 }
 
 /*
- * truecolor_search_right/truecolor_search_left: scan a horizontal run of
- * matching color on the packed truecolor screen, for contourfill()'s
- * seed-fill (see end_pts() in vdi_fill.c and the vdi_backend_ops comment
- * in vdi_backend.h).
+ * truecolor_scan_run: find the run of pixels matching (or not matching)
+ * search_col through (x,y) on the packed truecolor screen, for
+ * contourfill()'s span fill (see end_pts() in vdi_fill.c and the
+ * vdi_backend_ops comment in vdi_backend.h).
  *
  * search_col is a MAP_COL-mapped hardware palette index, like
  * get_pixel()'s return value -- converted to its raw packed pixel once,
- * up front, rather than calling get_pixel() (and paying its 256-entry
- * reverse palette search) again for every pixel of a scan that can span
- * the whole screen width.
+ * up front, so that the scan compares raw pixels rather than mapping
+ * each of them back to an index through get_pixel() (and the inverse
+ * palette hash) for a run that can span the whole screen width, the
+ * starting pixel included.
  */
-static WORD TC_SPARSE_UNUSED tc_search_right(const VwkClip *clip, WORD x, WORD y, UWORD search_col)
+static BOOL TC_SPARSE_UNUSED tc_scan_run(const VwkClip *clip, WORD x, WORD y, UWORD search_col,
+                                         WORD *xleft, WORD *xright)
 {
-    PIXEL pixel = tc_pixel_for_index((WORD)search_col);
-    const PIXEL *addr = tc_get_start_addr(x, y);
-
-    while (x++ < clip->xmx_clip) {
-        if (*++addr != pixel)
-            break;
+    const PIXEL pixel = tc_pixel_for_index((WORD)search_col);
+    const PIXEL *start = tc_get_start_addr(x, y);
+    const PIXEL *addr;
+    const BOOL match = (*start == pixel);
+    WORD n;
+
+    /* the loops are split on match, to keep the test out of them */
+    addr = start;
+    n = clip->xmx_clip - x;
+    if (match) {
+        for ( ; n > 0 && addr[1] == pixel; n--)
+            addr++;
+    } else {
+        for ( ; n > 0 && addr[1] != pixel; n--)
+            addr++;
     }
-    return x - 1;       /* output x coord -1 to endxright. */
-}
-
-static WORD TC_SPARSE_UNUSED tc_search_left(const VwkClip *clip, WORD x, WORD y, UWORD search_col)
-{
-    PIXEL pixel = tc_pixel_for_index((WORD)search_col);
-    const PIXEL *addr = tc_get_start_addr(x, y);
+    *xright = x + (WORD)(addr - start);
 
-    while (x-- > clip->xmn_clip) {
-        if (*--addr != pixel)
-            break;
+    addr = start;
+    n = x - clip->xmn_clip;
+    if (match) {
+        for ( ; n > 0 && addr[-1] == pixel; n--)
+            addr--;
+    } else {
+        for ( ; n > 0 && addr[-1] != pixel; n--)
+            addr--;
     }
-    return x + 1;       /* output x coord + 1 to endxleft. */
+    *xleft = x - (WORD)(start - addr);
+
+    return match;
 }
 
 static ULONG tc_get_raw_pixel(WORD x, WORD y)
@@ -0,0 +1,274 @@
+/*
+ * vdi_backend_truecolor_wrmode.c - per-write-mode packed truecolor loops
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ *
+ * This is NOT a build target either: vdi_backend_truecolor_tmpl.c
+ * #includes it four times, once per VDI write mode, so that the inner
+ * pixel loops of fill_rect/text_blit/draw_line/raster_copy carry no
+ * write-mode switch of their own.  The public entry points in the
+ * template pick the specialisation once per call.  Besides PIXEL and
+ * PIXEL_SIZE (see the template), it requires:
+ *
+ *   TC_WRMODE   the write mode of this instantiation (WM_REPLACE,
+ *               WM_TRANS, WM_XOR or WM_ERASE)
+ *   TC_WM(f)    the name of function f for this instantiation
+ *
+ * Every loop plots through TC_WM_PLOT() below, which is where the write
+ * mode semantics live:
+ *  - replace: a set bit writes fg, a clear bit writes bg;
+ *  - transparent: a set bit writes fg, a clear bit is left untouched;
+ *  - xor: a set bit inverts the pixel, regardless of any colour -- the
+ *    planar path XORs every plane, which is a full bitwise invert;
+ *  - erase (reverse transparent): a clear bit writes bg, a set bit is
+ *    left untouched.
+ * Callers pass whichever pixel each primitive wants for fg/bg; e.g.
+ * fill_rect() and text_blit() paint their foreground colour for the
+ * clear bits of erase mode, so they pass it as bg for that mode.
+ */
+
+#undef TC_WM_PLOT
+#if TC_WRMODE == WM_REPLACE
+#define TC_WM_PLOT(q, set, fg, bg)  (*(q) = (set) ? (fg) : (bg))
+#elif TC_WRMODE == WM_TRANS
+#define TC_WM_PLOT(q, set, fg, bg)  do { if (set) *(q) = (fg); } while (0)
+#elif TC_WRMODE == WM_XOR
+#define TC_WM_PLOT(q, set, fg, bg)  do { if (set) *(q) = (PIXEL)~*(q); } while (0)
+#else
+#define TC_WM_PLOT(q, set, fg, bg)  do { if (!(set)) *(q) = (bg); } while (0)
+#endif
+
+/*
+ * n pixels from p rightwards, all set or all clear in the source.
+ */
+static void TC_SPARSE_UNUSED TC_WM(tc_span)(PIXEL *p, WORD n, BOOL set, PIXEL fg, PIXEL bg)
+{
+#if TC_WRMODE == WM_REPLACE
+    tc_store_span(p, n, set ? fg : bg);
+#elif TC_WRMODE == WM_TRANS
+    if (set)
+        tc_store_span(p, n, fg);
+#elif TC_WRMODE == WM_XOR
+    if (set)
+        tc_invert_span(p, n);
+#else
+    if (!set)
+        tc_store_span(p, n, bg);
+#endif
+}
+
+/*
+ * Fill a rectangle with the 16-pixel-wide fill pattern.  A pattern row
+ * that is all ones or all zeros (every solid fill, and the blank rows of
+ * hatches) degenerates to a run of identical plots, which is written
+ * without looking at the pattern at all.
+ */
+static void TC_SPARSE_UNUSED TC_WM(tc_fill)(const VwkAttrib *attr, const Rect *rect,
+                                            PIXEL fg, PIXEL bg)
+{
+    const UWORD patmsk = attr->patmsk;
+    UBYTE *row = (UBYTE *)tc_get_start_addr(rect->x1, rect->y1);
+    WORD count = rect->x2 - rect->x1 + 1;
+    WORD y;
+
+    for (y = rect->y1; y <= rect->y2; y++, row += linea_vars.v_lin_wr) {
+        UWORD pattern = attr->patptr[patmsk & y];
+        PIXEL *dst = (PIXEL *)row;
+        WORD n;
+
+        if (pattern == 0xffff || pattern == 0x0000) {
+            TC_WM(tc_span)(dst, count, pattern != 0, fg, bg);
+        } else {
+            UWORD mask = 0x8000;
+
+            for (n = count; n > 0; n--, dst++) {
+                TC_WM_PLOT(dst, pattern & mask, fg, bg);
+                rorw1(mask);
+            }
+        }
+    }
+}
+
+/*
+ * The glyph loop of tc_text_blit(): src/dst/src_mask point at the bottom
+ * line of the glyph, which is drawn upwards (d_next is negative), see
+ * the setup there.
+ */
+static void TC_SPARSE_UNUSED TC_WM(tc_text)(LOCALVARS *vars, UBYTE *src, UBYTE *dst,
+                                            UWORD src_mask, WORD skew, UWORD skew_mask,
+                                            WORD skew_start, PIXEL fg, PIXEL bg)
+{
+    UBYTE *p;
+    PIXEL *q;
+    UWORD mask;
+    WORD h, w;
+
+    for (h = vars->height; h > 0; h--, src += vars->s_next, dst += vars->d_next)
+    {
+        p = src;
+        q = (PIXEL *)dst;
+        for (w = vars->width, mask = src_mask; w > 0; w--, q++)
+        {
+            TC_WM_PLOT(q, get_src_word(p) & mask, fg, bg);
+            rorw1(mask);
+            if (mask == 0x8000)
+                p += 2;
+        }
+        /*
+         * special handling for skewed text: since the character cells
+         * are effectively slanted, we must shift the starting position
+         * of a cell rightwards as we go up the character.
+         */
+        if (skew && (h <= skew_start))  /* OK to shift box for skewed text? */
+        {
+            rolw1(skew_mask);
+            if (skew_mask & 0x8000)
+            {
+                rorw1(src_mask);
+                if (src_mask == 0x8000)
+                    src++;
+                dst += PIXEL_SIZE;
+            }
+        }
+    }
+}
+
+/*
+ * 1bpp source (an icon shape/mask) to packed colour destination, for the
+ * transparent branch of tc_raster_copy().
+ */
+static void TC_SPARSE_UNUSED TC_WM(tc_expand)(const struct blit_frame *info, PIXEL fg, PIXEL bg)
+{
+    WORD y;
+
+    for (y = 0; y < info->b_ht; y++) {
+        const UBYTE *srow = (const UBYTE *)info->s_form
+            + (LONG)(info->s_ymin + y) * info->s_nxln;
+        UBYTE *drow = (UBYTE *)info->d_form
+            + (LONG)(info->d_ymin + y) * info->d_nxln;
+        const UBYTE *p = srow + (LONG)(info->s_xmin >> 4) * info->s_nxwd;
+        PIXEL *q = (PIXEL *)(drow + (LONG)info->d_xmin * info->d_nxwd);
+        UWORD mask = 0x8000 >> (info->s_xmin & 0x0f);
+        UWORD bits = *(const UWORD *)p;
+        WORD x;
+
+        for (x = info->b_wd; x > 0; x--, q++) {
+            /*
+             * Icon mask/data words are native-order WORD values, see
+             * the comment in tc_raster_copy().  The source word is only
+             * reloaded when the mask wraps around.
+             */
+            TC_WM_PLOT(q, bits & mask, fg, bg);
+            rorw1(mask);
+            if (mask == 0x8000 && x > 1) {
+                p += 2;
+                bits = *(const UWORD *)p;
+            }
+        }
+    }
+}
+
+#if TC_WRMODE != WM_ERASE
+/*
+ * The line loops of tc_draw_line().  adr is the first pixel, dx/dy the
+ * absolute extents and yinc the signed line stride.  The erase mode of a
+ * line behaves like transparent mode with the complemented colour (see
+ * tc_draw_line()), so there is no erase instantiation.
+ *
+ * A solid line (linemask 0xffff, which every rotation leaves unchanged)
+ * is drawn as a sequence of runs: for an x-major line, each horizontal
+ * run is as long as it takes the Bresenham error term to cross zero,
+ * which is either q or q+1 pixels once past the first run (q being
+ * dx/dy), so no per-pixel error update is needed.  The runs are computed
+ * from the very same error term as the per-pixel loop, so both light up
+ * exactly the same pixels -- which matters for XOR lines being erased by
+ * drawing them again, e.g. the rubber-band box.
+ *
+ * A styled line keeps the per-pixel loop: the pattern rotates once per
+ * pixel drawn, and the caller gets the rotated mask back.
+ */
+static UWORD TC_SPARSE_UNUSED TC_WM(tc_line)(UBYTE *adr, WORD dx, WORD dy, LONG yinc,
+                                             PIXEL fg, PIXEL bg, UWORD linemask)
+{
+    WORD loopcnt;
+
+    if (linemask == 0xffff) {
+        if (dx >= dy) {
+            WORD eps = -dx, e1 = 2*dy, e2 = 2*dx;
+            WORD q, k;
+
+            if (dy == 0) {
+                TC_WM(tc_span)((PIXEL *)adr, dx + 1, TRUE, fg, bg);
+                return linemask;
+            }
+            q = dx / dy;
+            k = (dx + e1 - 1) / e1;     /* first run: from -dx up to 0 */
+            for (loopcnt = dx + 1; loopcnt > 0; loopcnt -= k) {
+                if (k > loopcnt)
+                    k = loopcnt;
+                TC_WM(tc_span)((PIXEL *)adr, k, TRUE, fg, bg);
+                adr += (LONG)k * PIXEL_SIZE + yinc;
+                eps += k * e1 - e2;
+                k = q;
+                if (eps + q * e1 < 0)
+                    k++;
+            }
+        } else {
+            WORD eps = -dy, e1 = 2*dx, e2 = 2*dy;
+            WORD q, k;
+
+            if (dx == 0) {
+                q = k = dy + 1;
+            } else {
+                q = dy / dx;
+                k = (dy + e1 - 1) / e1;
+            }
+            for (loopcnt = dy + 1; loopcnt > 0; loopcnt -= k) {
+                WORD n;
+
+                if (k > loopcnt)
+                    k = loopcnt;
+                for (n = k; n > 0; n--, adr += yinc)
+                    TC_WM_PLOT((PIXEL *)adr, TRUE, fg, bg);
+                adr += PIXEL_SIZE;
+                eps += k * e1 - e2;
+                k = q;
+                if (eps + q * e1 < 0)
+                    k++;
+            }
+        }
+        return linemask;
+    }
+
+    if (dx >= dy) {
+        WORD eps = -dx, e1 = 2*dy, e2 = 2*dx;
+
+        for (loopcnt = dx; loopcnt >= 0; loopcnt--) {
+            rolw1(linemask);
+            TC_WM_PLOT((PIXEL *)adr, linemask & 1, fg, bg);
+            adr += PIXEL_SIZE;
+            eps += e1;
+            if (eps >= 0) {
+                eps -= e2;
+                adr += yinc;
+            }
+        }
+    } else {
+        WORD eps = -dy, e1 = 2*dx, e2 = 2*dy;
+
+        for (loopcnt = dy; loopcnt >= 0; loopcnt--) {
+            rolw1(linemask);
+            TC_WM_PLOT((PIXEL *)adr, linemask & 1, fg, bg);
+            adr += yinc;
+            eps += e1;
+            if (eps >= 0) {
+                eps -= e2;
+                adr += PIXEL_SIZE;
+            }
+        }
+    }
+
+    return linemask;
+}
+#endif
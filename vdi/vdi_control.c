@@ -14,7 +14,9 @@
 #include "config.h"
 #include "portab.h"
 #include "../bios/lineavars.h"
+#include "../bios/tosvars.h"
 #include "vdi_defs.h"
+#include "vdi_raster.h"
 /* #define ENABLE_KDEBUG */
 #include "kprint.h"
 #include "biosbind.h"
@@ -173,9 +175,59 @@ Vwk * vdi_physical_vwk(void)
 
 
 
+#if CONF_WITH_VDI_BITMAPS
+/*
+ * Off-screen bitmaps (v_opnbm())
+ *
+ * Whichever backend they use, the primitives draw through v_bas_ad,
+ * v_lin_wr and V_REZ_HZ/V_REZ_VT.  For the duration of a call on a
+ * bitmap workstation, screen() points these at the bitmap, which has the
+ * pixel format of the screen, and vdi_bitmap_leave() restores them.
+ * DEV_TAB is left alone, since the mouse interrupt clips the cursor
+ * position against it; the VBL routine that draws the mouse cursor goes
+ * through v_bas_ad as well, so it is held off by mouse_flag meanwhile.
+ */
+static UBYTE *screen_bas_ad;
+static UWORD screen_lin_wr, screen_rez_hz, screen_rez_vt;
+
+void vdi_bitmap_enter(Vwk * vwk)
+{
+    linea_vars.mouse_flag += 1;
+    screen_bas_ad = v_bas_ad;
+    screen_lin_wr = linea_vars.v_lin_wr;
+    screen_rez_hz = linea_vars.V_REZ_HZ;
+    screen_rez_vt = linea_vars.V_REZ_VT;
+
+    v_bas_ad = vwk->bm_addr;
+    linea_vars.v_lin_wr = vwk->bm_lin_wr;
+    linea_vars.V_REZ_HZ = vwk->bm_width;
+    linea_vars.V_REZ_VT = vwk->bm_height;
+}
+
+void vdi_bitmap_leave(void)
+{
+    v_bas_ad = screen_bas_ad;
+    linea_vars.v_lin_wr = screen_lin_wr;
+    linea_vars.V_REZ_HZ = screen_rez_hz;
+    linea_vars.V_REZ_VT = screen_rez_vt;
+    linea_vars.mouse_flag -= 1;
+}
+#endif
+
+
+
 /* Set Clip Region */
 void vdi_vs_clip(Vwk * vwk)
 {
+    WORD xmax = xres, ymax = yres;
+
+#if CONF_WITH_VDI_BITMAPS
+    if (vwk->bm_addr) {
+        xmax = vwk->bm_width - 1;
+        ymax = vwk->bm_height - 1;
+    }
+#endif
+
     vwk->clip = *INTIN;
     if (vwk->clip) {
         WORD rtemp;
@@ -189,16 +241,22 @@ void vdi_vs_clip(Vwk * vwk)
         vwk->ymn_clip = (rtemp < 0) ? 0 : rtemp;
 
         rtemp = rect->x2;
-        vwk->xmx_clip = (rtemp > xres) ? xres : rtemp;
+        vwk->xmx_clip = (rtemp > xmax) ? xmax : rtemp;
 
         rtemp = rect->y2;
-        vwk->ymx_clip = (rtemp > yres) ? yres : rtemp;
+        vwk->ymx_clip = (rtemp > ymax) ? ymax : rtemp;
     } else {
         vwk->xmn_clip = 0;
         vwk->ymn_clip = 0;
-        vwk->xmx_clip = xres;
-        vwk->ymx_clip = yres;
+        vwk->xmx_clip = xmax;
+        vwk->ymx_clip = ymax;
     }
+
+#if CONF_WITH_VDI_BITMAPS
+    /* nothing may be drawn outside a bitmap: it is always clipped */
+    if (vwk->bm_addr)
+        vwk->clip = TRUE;
+#endif
 }
 
 
@@ -331,6 +389,99 @@ static void init_wk(Vwk * vwk)
 
 
 
+#if CONF_WITH_VDI_BITMAPS
+/*
+ * Set up the bitmap of a v_opnbm() workstation from the MFDB in
+ * CONTRL->ptr1.  If its fd_addr is NULL, the bitmap is allocated with
+ * the size in INTIN[11]/INTIN[12] (width-1, height-1; the size of the
+ * screen if absent) and the MFDB is filled in.  Otherwise, it must
+ * describe memory in the device-specific format of the screen, with
+ * whole words per line.  Returns FALSE if the bitmap cannot be used.
+ */
+static BOOL bitmap_setup(Vwk * vwk)
+{
+    MFDB *mfdb = (MFDB *)CONTRL->ptr1;
+    const WORD planes = linea_vars.v_planes;
+    LONG lin_wr;
+
+    if (!mfdb)
+        return FALSE;
+
+    if (!mfdb->fd_addr) {
+        WORD width = 0, height = 0;
+        ULONG size;
+
+        if (CONTRL->nintin >= 13) {
+            width = INTIN[11] + 1;
+            height = INTIN[12] + 1;
+        }
+        if (width <= 0 || height <= 0) {
+            width = linea_vars.V_REZ_HZ;
+            height = linea_vars.V_REZ_VT;
+        }
+        width = (width + 15) & ~15;
+        if ((LONG)width * planes / 8 > 0x7fff)
+            return FALSE;
+
+        size = (ULONG)width * planes / 8 * height;
+        mfdb->fd_addr = (void *)trap1(X_MXALLOC, size, (WORD)(X_MXGLOBAL));
+        if (!mfdb->fd_addr)
+            return FALSE;
+
+        mfdb->fd_w = width;
+        mfdb->fd_h = height;
+        mfdb->fd_wdwidth = width / 16;
+        mfdb->fd_stand = 0;
+        mfdb->fd_nplanes = planes;
+        mfdb->fd_r1 = mfdb->fd_r2 = mfdb->fd_r3 = 0;
+        vwk->bm_allocated = TRUE;
+    } else {
+        if (mfdb->fd_nplanes == 0)
+            mfdb->fd_nplanes = planes;  /* i.e. the format of the screen */
+        if (mfdb->fd_stand || mfdb->fd_nplanes != planes
+         || mfdb->fd_w <= 0 || mfdb->fd_h <= 0 || mfdb->fd_w != mfdb->fd_wdwidth * 16)
+            return FALSE;
+    }
+
+    lin_wr = (LONG)mfdb->fd_wdwidth * 2 * planes;
+    if (lin_wr > 0x7fff) {
+        if (vwk->bm_allocated)
+            trap1(X_MFREE, mfdb->fd_addr);
+        return FALSE;
+    }
+
+    vwk->bm_addr = mfdb->fd_addr;
+    vwk->bm_lin_wr = lin_wr;
+    vwk->bm_width = mfdb->fd_w;
+    vwk->bm_height = mfdb->fd_h;
+
+    return TRUE;
+}
+
+/*
+ * The parts of init_wk() that differ for a bitmap: its size and clipping,
+ * and a freshly allocated bitmap is cleared like a screen.
+ */
+static void bitmap_init_wk(Vwk * vwk)
+{
+    vwk->xmx_clip = vwk->bm_width - 1;
+    vwk->ymx_clip = vwk->bm_height - 1;
+    vwk->clip = TRUE;                   /* see vdi_vs_clip() */
+
+    INTOUT[0] = vwk->bm_width - 1;
+    INTOUT[1] = vwk->bm_height - 1;
+
+    if (vwk->bm_allocated) {
+        vdi_bitmap_enter(vwk);
+        vdi_v_clrwk(vwk);
+        vdi_bitmap_leave();
+    }
+}
+#endif
+
+/*
+ * v_opnvwk(), and v_opnbm() (subcode 1) if off-screen bitmaps are supported
+ */
 void vdi_v_opnvwk(Vwk * vwk)
 {
     WORD handle;
@@ -346,6 +497,16 @@ void vdi_v_opnvwk(Vwk * vwk)
         return;
     }
 
+#if CONF_WITH_VDI_BITMAPS
+    vwk->bm_addr = NULL;
+    vwk->bm_allocated = FALSE;
+    if (CONTRL->subcode == 1 && !bitmap_setup(vwk)) {
+        trap1(X_MFREE, vwk);
+        CONTRL->handle = 0;
+        return;
+    }
+#endif
+
     /* Now find a free handle (start with 2, since 1 is the handle of the physical station) */
     handle = 2;
     work_ptr = &virt_work;
@@ -360,6 +521,10 @@ void vdi_v_opnvwk(Vwk * vwk)
 
     vwk->handle = CONTRL->handle = handle;
     init_wk(vwk);
+#if CONF_WITH_VDI_BITMAPS
+    if (vwk->bm_addr)
+        bitmap_init_wk(vwk);
+#endif
     linea_vars.CUR_WORK = vwk;
 }
 
@@ -398,6 +563,11 @@ void vdi_v_clsvwk(Vwk * vwk)
         vdi_backend_set_active_vwk(vdi_physical_vwk());
 #endif
 
+#if CONF_WITH_VDI_BITMAPS
+    /* v_clsbm() (subcode 1) is the same, and frees what v_opnbm() allocated */
+    if (vwk->bm_allocated)
+        trap1(X_MFREE, vwk->bm_addr);
+#endif
     trap1(X_MFREE, vwk);
 }
 
@@ -479,6 +649,10 @@ void vdi_v_clswk(Vwk * vwk)
         vwk = virt_work.next_work;
         do {
             next_work = vwk->next_work;
+#if CONF_WITH_VDI_BITMAPS
+            if (vwk->bm_allocated)
+                trap1(X_MFREE, vwk->bm_addr);
+#endif
             trap1(X_MFREE, vwk);
         } while ((vwk = next_work));
     }
@@ -576,6 +750,13 @@ void vdi_vq_extnd(Vwk * vwk)
     dst = INTOUT;
     for (i = 0; i < 45; i++)
         *dst++ = *src++;
+
+#if CONF_WITH_VDI_BITMAPS
+    if (vwk->bm_addr && *INTIN == 0) {
+        INTOUT[0] = vwk->bm_width - 1;
+        INTOUT[1] = vwk->bm_height - 1;
+    }
+#endif
 }
 
 
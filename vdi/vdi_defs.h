@@ -160,6 +160,8 @@ typedef struct {
 
 /* Structure to hold data for a virtual workstation */
 
+#define TC_INVERSE_SIZE 512     /* slots in Vwk.tc_inverse[], a power of 2 */
+
 /* NOTE 1: for backwards compatibility with all versions of TOS, the
  * field 'fill_color' must remain at offset 0x1e, because the line-A
  * flood fill function uses the fill colour from the currently-open
@@ -215,6 +217,14 @@ struct Vwk_ {
     WORD bez_qual;              /* actual quality for bezier curves */
     SCREEN_MODE_DESC mode;      /* backend mode descriptor for this workstation's screen */
     const struct vdi_backend_ops *backend; /* dispatch table selected for `mode`; NULL if none matched */
+#if CONF_WITH_VDI_BITMAPS
+    /* off-screen bitmap of a v_opnbm() workstation, NULL for the screen */
+    UBYTE *bm_addr;
+    WORD bm_lin_wr;             /* bytes per line */
+    WORD bm_width;              /* size in pixels */
+    WORD bm_height;
+    BOOL bm_allocated;          /* bm_addr was allocated by v_opnbm() */
+#endif
 #if CONF_WITH_VDI_BACKEND_TRUECOLOR
     /*
      * vs_color()/vq_color() pseudo-palette for the truecolor backend
@@ -239,6 +249,14 @@ struct Vwk_ {
      * alongside tc_palette by vdi_truecolor_init_palette().
      */
     WORD tc_req_col[256][3];
+    /*
+     * Inverse of tc_palette[], for get_pixel(): an open-addressing hash
+     * from packed pixel value to 1 + the lowest index holding it, 0 for
+     * an empty slot.  Rebuilt on first use after tc_palette[] changes,
+     * see vdi_truecolor_index_for_pixel().
+     */
+    UWORD tc_inverse[TC_INVERSE_SIZE];
+    BOOL tc_inverse_valid;
 #endif
 };
 
@@ -297,6 +315,10 @@ int GSX_ENTRY(int op, VDIPB* paramblock);
 /* C Support routines */
 Vwk * get_vwk_by_handle(WORD);
 Vwk * vdi_physical_vwk(void);
+#if CONF_WITH_VDI_BITMAPS
+void vdi_bitmap_enter(Vwk *);
+void vdi_bitmap_leave(void);
+#endif
 UWORD * get_start_addr(const WORD x, const WORD y);
 void set_LN_MASK(Vwk *vwk);
 void st_fl_ptr(Vwk *);
@@ -355,14 +377,12 @@ UWORD truecolor_get_pixel(WORD x, WORD y);
 void truecolor_put_pixel(WORD x, WORD y, UWORD color);
 void truecolor_fill_rect(const VwkAttrib *attr, const Rect *rect);
 UWORD truecolor_draw_line(const Line *line, WORD wrt_mode, UWORD color, UWORD linemask);
-WORD truecolor_search_right(const VwkClip *clip, WORD x, WORD y, UWORD search_col);
-WORD truecolor_search_left(const VwkClip *clip, WORD x, WORD y, UWORD search_col);
+BOOL truecolor_scan_run(const VwkClip *clip, WORD x, WORD y, UWORD search_col, WORD *xleft, WORD *xright);
 void clc_flit (const VwkAttrib * attr, const VwkClip * clipper, const Point * point, WORD y, int vectors);
 void abline (const Line * line, const WORD wrt_mode, UWORD color);
 UWORD planar_draw_line(const Line * line, WORD wrt_mode, UWORD color, UWORD linemask);
-WORD planar_search_right(const VwkClip * clip, WORD x, WORD y, UWORD search_col);
-WORD planar_search_left(const VwkClip * clip, WORD x, WORD y, UWORD search_col);
-void contourfill(const VwkAttrib * attr, const VwkClip *clip);
+BOOL planar_scan_run(const VwkClip * clip, WORD x, WORD y, UWORD search_col, WORD * xleft, WORD * xright);
+BOOL contourfill(const VwkAttrib * attr, const VwkClip *clip);
 
 /* initialization of subsystems */
 void text_init(void);
@@ -21,19 +21,11 @@
 #include "../bios/tosvars.h"
 #include "../bios/lineavars.h"
 
-#define EMPTY   0xffff
 #define NOT_FOUND -1
-#define DOWN_FLAG 0x8000
-#define QSIZE 200
-
-
-
-#define ABS(v) (v & 0x7FFF)
 
 
 
 /* prototypes */
-static void crunch_queue(void);
 static BOOL clipbox(const VwkClip * clip, Rect * rect);
 
 
@@ -42,15 +34,6 @@ static BOOL clipbox(const VwkClip * clip, Rect * rect);
 static UWORD search_color;       /* the color of the border      */
 
 
-/* some kind of stack for the segments to fill */
-static UWORD queue[QSIZE];      /* storage for the seed points  */
-static WORD qbottom;            /* the bottom of the queue (zero)   */
-static WORD qtop;               /* points to seed +3            */
-static WORD qptr;               /* points to the active point   */
-static WORD qtmp;
-static WORD qhole;              /* an empty space in the queue */
-
-
 /* the storage for the used defined fill pattern */
 const UWORD ROM_UD_PATRN[16] = {
     0x07E0, 0x0FF0, 0x1FD8, 0x1808, 0x1808, 0x1008, 0x1E78, 0x1348,
@@ -342,9 +325,12 @@ st_fl_ptr(Vwk * vwk)
 
 
 /*
- * bub_sort - sorts an array of words
+ * sort_intersections - sorts an array of words
  *
- * This routine bubble-sorts an array of words into ascending order.
+ * This routine insertion-sorts an array of words into ascending order.
+ * The lists it gets are short, and those of polygon() are nearly sorted
+ * already (the order of the edges only changes where two of them cross),
+ * which is the case insertion sort handles in linear time.
  *
  * input:
  *     buf   - ptr to start of array.
@@ -352,34 +338,21 @@ st_fl_ptr(Vwk * vwk)
  */
 
 static void
-bub_sort (WORD * buf, WORD count)
+sort_intersections(WORD * buf, WORD count)
 {
-    int i, j;
-
-    for (i = count-1; i > 0; i--) {
-        WORD * ptr = buf;               /* reset pointer to the array */
-        for (j = 0; j < i; j++) {
-            WORD val = *ptr++;   /* word */    /* get next value */
-            if ( val > *ptr ) {    /* yes - do nothing */
-                *(ptr-1) = *ptr;   /* word */    /* nope - swap them */
-                *ptr = val;   /* word */
-            }
-        }
+    WORD i, j;
+
+    for (i = 1; i < count; i++) {
+        WORD val = buf[i];
+
+        for (j = i; j > 0 && buf[j-1] > val; j--)
+            buf[j] = buf[j-1];
+        buf[j] = val;
     }
 }
 
 
 
-/*
- * clc_flit - draw a filled polygon
- *
- * (Sutherland and Hodgman Polygon Clipping Algorithm)
- *
- * For each non-horizontal scanline crossing poly, do:
- *   - find intersection points of scan line with poly edges.
- *   - Sort intersections left to right
- *   - Draw pixels between each pair of points (x coords) on the scan line
- */
 /*
  * the buffer used by clc_flit() has been temporarily moved from the
  * stack to a local static area.  this avoids some cases of stack
@@ -393,10 +366,97 @@ bub_sort (WORD * buf, WORD count)
 #define MAX_INTERSECTIONS   256
 static WORD fill_buffer[MAX_INTERSECTIONS];
 
+/*
+ * fill_spans - draw the spans between pairs of sorted intersections
+ *
+ * The x-values are taken from fill_buffer[]; an odd one out at the end
+ * is ignored.
+ */
+static void
+fill_spans(const VwkAttrib * attr, const VwkClip * clipper, WORD y, int intersections)
+{
+    WORD * ptr = fill_buffer;
+    int i;
+
+    /*
+     * Testing under Atari TOS shows that the fill area always *includes*
+     * the left & right perimeter (for those functions that allow the
+     * perimeter to be drawn separately, it is drawn on top of the edge
+     * pixels).  We now conform to Atari TOS.
+     */
+
+    if (attr->clip) {
+        /*
+         * Clipping is in force.  Clip the endpoints of the line segment
+         * to the left and right sides of the clipping rectangle.
+         */
+
+        /* loop through buffered points */
+        for (i = intersections / 2 - 1; i >= 0; i--) {
+            WORD x1, x2;
+            Rect rect;
+
+            /* grab a pair of endpoints */
+            x1 = *ptr++;
+            x2 = *ptr++;
+
+            if ( x1 < clipper->xmn_clip ) {
+                if ( x2 < clipper->xmn_clip )
+                    continue;           /* entire segment clipped left */
+                x1 = clipper->xmn_clip; /* clip left end of line */
+            }
+
+            if ( x2 > clipper->xmx_clip ) {
+                if ( x1 > clipper->xmx_clip )
+                    continue;           /* entire segment clippped */
+                x2 = clipper->xmx_clip; /* clip right end of line */
+            }
+            rect.x1 = x1;
+            rect.y1 = y;
+            rect.x2 = x2;
+            rect.y2 = y;
+
+            /* rectangle fill routine draws horizontal line */
+            draw_rect_common(attr, &rect);
+        }
+    }
+    else {
+        /* Clipping is not in force.  Draw from point to point. */
+
+        /* loop through buffered points */
+        for (i = intersections / 2 - 1; i >= 0; i--) {
+            Rect rect;
+
+            /* grab a pair of endpoints */
+            rect.x1 = *ptr++;
+            rect.y1 = y;
+            rect.x2 = *ptr++;
+            rect.y2 = y;
+
+            /* rectangle fill routine draws horizontal line */
+            draw_rect_common(attr, &rect);
+        }
+    }
+}
+
+
+
+/*
+ * clc_flit - draw a filled polygon
+ *
+ * (Sutherland and Hodgman Polygon Clipping Algorithm)
+ *
+ * For each non-horizontal scanline crossing poly, do:
+ *   - find intersection points of scan line with poly edges.
+ *   - Sort intersections left to right
+ *   - Draw pixels between each pair of points (x coords) on the scan line
+ *
+ * This draws a single scan line, for Line-A's polygon call; polygon()
+ * itself keeps its intersections from one scan line to the next.
+ */
 void
 clc_flit (const VwkAttrib * attr, const VwkClip * clipper, const Point * point, WORD y, int vectors)
 {
-//    WORD fill_buffer[256];      /* must be 256 words or it will fail */
     WORD * bufptr;              /* point to array of x-values. */
     int intersections;          /* count of intersections */
     int i;
@@ -459,76 +519,191 @@ clc_flit (const VwkAttrib * attr, const VwkClip * clipper, const Point * point,
     if (intersections == 0)
         return;
 
-    /* bubblesort the intersections, if it makes sense */
+    /* sort the intersections, if it makes sense */
     if ( intersections > 1 )
-        bub_sort(fill_buffer, intersections);
+        sort_intersections(fill_buffer, intersections);
 
-    /*
-     * Testing under Atari TOS shows that the fill area always *includes*
-     * the left & right perimeter (for those functions that allow the
-     * perimeter to be drawn separately, it is drawn on top of the edge
-     * pixels).  We now conform to Atari TOS.
-     */
+    fill_spans(attr, clipper, y, intersections);
+}
 
-    if (attr->clip) {
-        /*
-         * Clipping is in force.  Clip the endpoints of the line segment
-         * to the left and right sides of the clipping rectangle.
-         */
 
-        /* loop through buffered points */
-        WORD * ptr = fill_buffer;
-        for (i = intersections / 2 - 1; i >= 0; i--) {
-            WORD x1, x2;
-            Rect rect;
 
-            /* grab a pair of endpoints */
-            x1 = *ptr++;
-            x2 = *ptr++;
+/*
+ * The edge table of polygon().
+ *
+ * clc_flit() computes the intersection of an edge with scan line y as
+ *
+ *     x = ((n * 2dx / dy + 1) >> 1) + xa
+ *
+ * with n = y - ya, where (xa,ya) is the left end of the edge, and dx/dy
+ * are taken from its first to its second point.  polygon() produces the
+ * very same x-values, but instead of a multiplication and a division per
+ * edge and scan line, it steps the quotient and remainder of |n * 2dx|
+ * by |dy| along with y.  Going upwards (y decreasing), |n| grows when
+ * the anchor is the bottom end of the edge and shrinks otherwise.
+ */
+typedef struct {
+    WORD top;           /* first scan line crossing the edge (max. y - 1) */
+    WORD bottom;        /* last scan line crossing the edge (min. y) */
+    WORD xa;            /* x of the anchor end of the edge */
+    WORD x;             /* the intersection with the current scan line */
+    UWORD ady;          /* |dy| */
+    UWORD step_r;       /* |2dx| % |dy| */
+    UWORD r;            /* |n * 2dx| % |dy| */
+    BYTE neg;           /* the quotient n * 2dx / dy is negative */
+    BYTE grow;          /* |n| grows going up: the anchor is the top end */
+    LONG step_q;        /* |2dx| / |dy| */
+    LONG q;             /* |n * 2dx| / |dy| */
+} Edge;
+
+#define MAX_EDGES   MAX_PTSIN
 
-            if ( x1 < clipper->xmn_clip ) {
-                if ( x2 < clipper->xmn_clip )
-                    continue;           /* entire segment clipped left */
-                x1 = clipper->xmn_clip; /* clip left end of line */
-            }
+/*
+ * A section of a scan line, in the queue of contourfill() (see there).
+ */
+#define MAX_SEEDS   512
+#define SEED_HASH   128         /* buckets, must be a power of 2 */
 
-            if ( x2 > clipper->xmx_clip ) {
-                if ( x1 > clipper->xmx_clip )
-                    continue;           /* entire segment clippped */
-                x2 = clipper->xmx_clip; /* clip right end of line */
-            }
-            rect.x1 = x1;
-            rect.y1 = y;
-            rect.x2 = x2;
-            rect.y2 = y;
+typedef struct {
+    WORD y;                     /* scan line of the section */
+    WORD xleft;                 /* left end of the section */
+    WORD xright;                /* right end */
+    WORD next;                  /* next section in its list */
+    WORD hnext;                 /* next section in the same hash bucket */
+} Seed;
 
-            /* rectangle fill routine draws horizontal line */
-            draw_rect_common(attr, &rect);
-        }
-    }
-    else {
-        /* Clipping is not in force.  Draw from point to point. */
+/*
+ * polygon() and contourfill() never run at the same time, so their
+ * tables share the same storage.
+ */
+static union {
+    struct {
+        Edge edges[MAX_EDGES];
+        WORD order[MAX_EDGES];      /* the edges, by descending top */
+        WORD active[MAX_EDGES];     /* the edges crossing the scan line */
+    } poly;
+    struct {
+        Seed seeds[MAX_SEEDS];
+        WORD hash[SEED_HASH];       /* first section in each bucket */
+    } fill;
+} fill_tables;
+
+static Edge * const edges = fill_tables.poly.edges;
+static WORD * const edge_order = fill_tables.poly.order;
+static WORD * const active = fill_tables.poly.active;
+static Seed * const seeds = fill_tables.fill.seeds;
+static WORD * const seed_hash = fill_tables.fill.hash;
 
-        /* loop through buffered points */
-        WORD * ptr = fill_buffer;
-        for (i = intersections / 2 - 1; i >= 0; i--) {
-            Rect rect;
+static WORD
+edge_x(const Edge * e)
+{
+    LONG q = e->neg ? -e->q : e->q;
 
-            /* grab a pair of endpoints */
-            rect.x1 = *ptr++;
-            rect.y1 = y;
-            rect.x2 = *ptr++;
-            rect.y2 = y;
+    return (WORD)(((q + 1) >> 1) + e->xa);
+}
 
-            /* rectangle fill routine draws horizontal line */
-            draw_rect_common(attr, &rect);
+/*
+ * edge_start - compute the intersection of an edge with scan line y,
+ * the first one it is active on
+ */
+static void
+edge_start(Edge * e, WORD y)
+{
+    ULONG n = e->grow ? (ULONG)(e->top + 1 - y) : (ULONG)(y - e->bottom);    /* |y - ya| */
+    ULONG p = n * ((ULONG)e->step_q * e->ady + e->step_r);
+
+    e->q = p / e->ady;
+    e->r = (UWORD)(p % e->ady);
+    e->x = edge_x(e);
+}
+
+/*
+ * edge_step - move an edge from scan line y+1 up to y
+ */
+static void
+edge_step(Edge * e)
+{
+    if (e->grow) {
+        ULONG r = (ULONG)e->r + e->step_r;
+
+        e->q += e->step_q;
+        if (r >= e->ady) {
+            r -= e->ady;
+            e->q++;
+        }
+        e->r = (UWORD)r;
+    } else {
+        e->q -= e->step_q;
+        if (e->r < e->step_r) {
+            e->r += e->ady;
+            e->q--;
         }
+        e->r -= e->step_r;
     }
+    e->x = edge_x(e);
 }
 
+/*
+ * build_edges - fill edges[] and edge_order[] from a closed polygon
+ *
+ * Returns the number of non-horizontal edges.
+ */
+static WORD
+build_edges(const Point * point, int count)
+{
+    WORD nedges = 0;
+    WORD i, j;
+
+    for (i = 0; i < count; i++, point++) {
+        Edge *e = &edges[nedges];
+        WORD x1 = point[0].x, y1 = point[0].y;
+        WORD x2 = point[1].x, y2 = point[1].y;
+        LONG dx = x2 - x1, dy = y2 - y1;
+        ULONG adx2;
+        WORD ya;
+
+        if (dy == 0)
+            continue;               /* horizontal edges are ignored */
+
+        if (dy < 0) {
+            e->top = y1 - 1;
+            e->bottom = y2;
+        } else {
+            e->top = y2 - 1;
+            e->bottom = y1;
+        }
+        /* the same choice of anchor as in clc_flit() */
+        if (dx < 0) {
+            e->xa = x2;
+            ya = y2;
+        } else {
+            e->xa = x1;
+            ya = y1;
+        }
+        e->grow = (ya > e->top);
+        e->neg = ((dx < 0) != (dy < 0)) != (e->grow != 0);
+        e->ady = (UWORD)(dy < 0 ? -dy : dy);
+        adx2 = (ULONG)(dx < 0 ? -dx : dx) << 1;
+        e->step_q = adx2 / e->ady;
+        e->step_r = (UWORD)(adx2 % e->ady);
+
+        /* insert it into the order of activation */
+        for (j = nedges; j > 0 && edges[edge_order[j-1]].top < e->top; j--)
+            edge_order[j] = edge_order[j-1];
+        edge_order[j] = nedges++;
+    }
+
+    return nedges;
+}
 
 /*
  * polygon - draw a filled polygon
+ *
+ * This is a scan-line fill with an active edge table: the edges are sorted
+ * by the scan line they start on, and the ones crossing the current scan
+ * line are kept sorted by their intersection, which is stepped
+ * incrementally from one scan line to the next (see Edge above).  The
+ * pixels drawn are exactly those of clc_flit() run on every scan line.
  */
 
 void
@@ -536,6 +711,7 @@ polygon(Vwk * vwk, Point * ptsin, int count)
 {
     WORD i, k, y;
     WORD fill_maxy, fill_miny;
+    WORD nedges, nactive, next;
     Point * point, * ptsget, * ptsput;
     const VwkClip *clipper;
     VwkAttrib attr;
@@ -583,9 +759,53 @@ polygon(Vwk * vwk, Point * ptsin, int count)
     /* copy data needed by clc_flit -> draw_rect_common */
     Vwk2Attrib(vwk, &attr, vwk->fill_color);
 
-    /* really draw it */
-    for (y = fill_maxy; y > fill_miny; y--) {
-        clc_flit(&attr, clipper, ptsin, y, count);
+    if (count > MAX_EDGES) {
+        /* too many edges for the edge table: one scan line at a time */
+        for (y = fill_maxy; y > fill_miny; y--) {
+            clc_flit(&attr, clipper, ptsin, y, count);
+        }
+    } else {
+        nedges = build_edges(ptsin, count);
+        nactive = next = 0;
+
+        /* really draw it */
+        for (y = fill_maxy; y > fill_miny; y--) {
+            /* drop the edges that ended below this scan line, step the others */
+            for (i = k = 0; i < nactive; i++) {
+                Edge *e = &edges[active[i]];
+
+                if (e->bottom > y)
+                    continue;
+                edge_step(e);
+                active[k++] = active[i];
+            }
+            nactive = k;
+
+            /* add the edges starting on this scan line */
+            while (next < nedges && edges[edge_order[next]].top >= y) {
+                Edge *e = &edges[edge_order[next]];
+
+                if (e->bottom <= y) {   /* else it is entirely clipped away */
+                    edge_start(e, y);
+                    active[nactive++] = edge_order[next];
+                }
+                next++;
+            }
+
+            /* keep the table sorted by intersection */
+            for (i = 1; i < nactive; i++) {
+                WORD n = active[i];
+                WORD x = edges[n].x;
+
+                for (k = i; k > 0 && edges[active[k-1]].x > x; k--)
+                    active[k] = active[k-1];
+                active[k] = n;
+            }
+
+            for (i = 0; i < nactive; i++)
+                fill_buffer[i] = edges[active[i]].x;
+            fill_spans(&attr, clipper, y, nactive);
+        }
     }
     if (vwk->fill_per == TRUE) {
         linea_vars.LN_MASK = 0xffff;
@@ -747,85 +967,106 @@ UWORD planar_get_pixel(WORD x, WORD y)
 }
 
 /*
- * planar_search_right/planar_search_left - scan a horizontal run of
- * matching color on the interleaved-bitplane screen, for contourfill()'s
- * seed-fill (see end_pts() below and the vdi_backend_ops comment in
- * vdi_backend.h). Unlike pixelread()'s general-purpose per-pixel
- * dispatch, these walk the bitplane mask/address incrementally instead
- * of recomputing it from (x,y) at every step.
+ * planar_scan_run - find the run of pixels matching (or not matching)
+ * search_col through (x,y) on the interleaved-bitplane screen, for
+ * contourfill()'s seed fill (see end_pts() below and the vdi_backend_ops
+ * comment in vdi_backend.h).
+ *
+ * The planes of a 16-pixel word group are compared with search_col all
+ * at once, giving one bit per pixel that continues the run, so a word
+ * group entirely within the run is skipped without looking at its pixels.
  */
-WORD
-planar_search_right(const VwkClip * clip, WORD x, WORD y, UWORD search_col)
+static UWORD
+run_bits(const UWORD * addr, UWORD search_col, BOOL match)
 {
-    UWORD *addr = planar_get_start_addr(x, y) + linea_vars.v_planes;
-    UWORD mask = 0x8000 >> (x & 0x000f);
+    UWORD bits = 0xffff;
+    WORD plane;
 
-    /* is x coord < x resolution ? */
-    while( x++ < clip->xmx_clip ) {
-        UWORD color;
+    for (plane = 0; plane < linea_vars.v_planes; plane++, search_col >>= 1)
+        bits &= (search_col & 1) ? addr[plane] : ~addr[plane];
 
-        /* need to jump over interleaved bit_plane? */
+    return match ? bits : ~bits;
+}
+
+BOOL
+planar_scan_run(const VwkClip * clip, WORD x, WORD y, UWORD search_col,
+                WORD * xleft, WORD * xright)
+{
+    UWORD *start = planar_get_start_addr(x, y);
+    UWORD start_mask = 0x8000 >> (x & 0x000f);
+    BOOL match = (run_bits(start, search_col, TRUE) & start_mask) != 0;
+    UWORD *addr, mask, bits;
+    WORD i;
+
+    /* search to the right, i being the last pixel of the run so far */
+    addr = start;
+    mask = start_mask;
+    bits = run_bits(addr, search_col, match);
+    for (i = x; i < clip->xmx_clip; i++) {
         mask = mask >> 1 | mask << 15;  /* roll right */
-        if ( mask & 0x8000 )
+        if (mask & 0x8000) {
+            /* jump over the interleaved bit_planes */
             addr += linea_vars.v_planes;
-
-        /* search, while pixel color != search color */
-        color = get_color(mask, addr);
-        if ( search_col != color ) {
-            break;
+            bits = run_bits(addr, search_col, match);
+            if (bits == 0xffff && clip->xmx_clip - i >= 16) {
+                i += 15;
+                mask = 0x0001;
+                continue;
+            }
         }
-
+        if (!(bits & mask))
+            break;
     }
-    return x - 1;       /* output x coord -1 to endxright. */
-}
-
-WORD
-planar_search_left(const VwkClip * clip, WORD x, WORD y, UWORD search_col)
-{
-    UWORD *addr = planar_get_start_addr(x, y) + linea_vars.v_planes;
-    UWORD mask = 0x8000 >> (x & 0x000f);
+    *xright = i;
 
     /* Now, search to the left. */
-    while (x-- > clip->xmn_clip) {
-        UWORD color;
-
-        /* need to jump over interleaved bit_plane? */
+    addr = start;
+    mask = start_mask;
+    bits = run_bits(addr, search_col, match);
+    for (i = x; i > clip->xmn_clip; i--) {
         mask = mask >> 15 | mask << 1;  /* roll left */
-        if ( mask & 0x0001 )
+        if (mask & 0x0001) {
             addr -= linea_vars.v_planes;
-
-        /* search, while pixel color != search color */
-        color = get_color(mask, addr);
-        if ( search_col != color )
+            bits = run_bits(addr, search_col, match);
+            if (bits == 0xffff && i - clip->xmn_clip >= 16) {
+                i -= 15;
+                mask = 0x8000;
+                continue;
+            }
+        }
+        if (!(bits & mask))
             break;
-
     }
+    *xleft = i;
 
-    return x + 1;       /* output x coord + 1 to endxleft. */
+    return match;
 }
 
 /*
  * end_pts - find the endpoints of a section of solid color
  *           (for the _seed_fill routine.)
  *
- * input:  4(sp) = xstart.
- *         6(sp) = ystart.
- *         8(sp) = ptr to endxleft.
- *         C(sp) = ptr to endxright.
+ * input:  x, y      = the start point.
+ *         seed_type = the type of fill: 1 fills the search colour, 0
+ *                     everything but the (border) search colour.
+ *
+ * output: xleftout  := left endpoint of the section.
+ *         xrightout := right endpoint of the section.
+ *         return    := success flag.
+ *             0 => the section is not to be filled, or outside the clip.
+ *             1 => the section is to be filled.
  *
- * output: endxleft  := left endpoint of solid color.
- *         endxright := right endpoint of solid color.
- *         d0        := success flag.
- *             0 => no endpoints or xstart on edge.
- *             1 => endpoints found.
- *         seed_type  indicates the type of fill
+ * A section is the longest run through (x,y) of pixels that are all
+ * to be filled, or all not to be: the backend returns it with a single
+ * scan of the row.  For a border fill, this means the run of pixels of
+ * any colour but the border's, not just those of the colour at (x,y).
  */
 
 static WORD
 end_pts(const VwkClip * clip, WORD x, WORD y, WORD *xleftout, WORD *xrightout,
         BOOL seed_type)
 {
-    UWORD color;
+    BOOL match;
 
     /* see, if we are in the y clipping range */
     if ( y < clip->ymn_clip || y > clip->ymx_clip) {
@@ -842,76 +1083,214 @@ end_pts(const VwkClip * clip, WORD x, WORD y, WORD *xleftout, WORD *xrightout,
             *xleftout = *xrightout = x;
             return 0;
         }
-        /* get the search color -- reuse backend, don't re-derive it via pixelread() */
-        color = backend->get_pixel(x, y);
-        *xrightout = backend->search_right(clip, x, y, color);
-        *xleftout = backend->search_left(clip, x, y, color);
+        match = backend->scan_run(clip, x, y, search_color, xleftout, xrightout);
     }
 #elif CONF_WITH_VDI_BACKEND_TRUECOLOR
     /*
      * Truecolor-only build: call the packed backend's primitives directly
      * (see the comment in get_start_addr() in vdi_misc.c).
      */
-    color = truecolor_get_pixel(x, y);
-    *xrightout = truecolor_search_right(clip, x, y, color);
-    *xleftout = truecolor_search_left(clip, x, y, color);
+    match = truecolor_scan_run(clip, x, y, search_color, xleftout, xrightout);
 #else
     /*
      * Planar-only build: call the planar primitives directly (see the
      * comment on get_start_addr() in vdi_misc.c).
      */
-    color = planar_get_pixel(x, y);
-    *xrightout = planar_search_right(clip, x, y, color);
-    *xleftout = planar_search_left(clip, x, y, color);
+    match = planar_scan_run(clip, x, y, search_color, xleftout, xrightout);
 #endif
 
-    /* see, if the whole found segment is of search color? */
-    if ( color != search_color ) {
-        return seed_type ^ 1;   /* return segment not of search color */
-    }
-    return seed_type ^ 0;       /* return segment is of search color */
+    /* is the section to be filled? */
+    return match ? seed_type : !seed_type;
+}
+
+/*
+ * The section queue of contourfill().
+ *
+ * A queued section is known to be filled, and is still to be drawn and
+ * searched around, i.e. the scan lines above and below it are still to
+ * be scanned for the sections touching it.  Sections are taken out in
+ * the order they were put in.  Once drawn, a section is kept on the done
+ * list: a scan running into a section queued or done has nothing left to
+ * do there.  Without that record, a border fill (whose drawn pixels still
+ * differ from the border colour) would go round in circles.  When all
+ * entries are in use, the oldest section done is forgotten first; the
+ * queue only overflows when all MAX_SEEDS of them are still to be drawn,
+ * which takes a wavefront of that many separate sections (a fine comb
+ * or maze pattern across a wide screen).  A section that finds the
+ * queue full is dropped, so the area only reachable through it is left
+ * unfilled: see contourfill().
+ *
+ * Every section is also on a short chain of those sharing the same hash
+ * bucket, which is all seen_before() has to look at.
+ */
+#define SEED_BUCKET(y, xleft)   (((y) ^ (xleft)) & (SEED_HASH - 1))
+
+typedef struct {
+    WORD head;                  /* the oldest section */
+    WORD tail;                  /* the newest section */
+} SeedList;
+
+static SeedList queue;          /* the sections still to be drawn */
+static SeedList done;           /* the sections drawn */
+static WORD qfree;              /* the first unused entry */
+
+static void
+init_queue(void)
+{
+    WORD i;
+
+    for (i = 0; i < SEED_HASH; i++)
+        seed_hash[i] = NOT_FOUND;
+    for (i = 0; i < MAX_SEEDS - 1; i++)
+        seeds[i].next = i + 1;
+    seeds[i].next = NOT_FOUND;
+    qfree = 0;
+    queue.head = queue.tail = NOT_FOUND;
+    done.head = done.tail = NOT_FOUND;
+}
+
+static void
+list_append(SeedList *list, WORD i)
+{
+    seeds[i].next = NOT_FOUND;
+    if (list->tail == NOT_FOUND)
+        list->head = i;
+    else
+        seeds[list->tail].next = i;
+    list->tail = i;
 }
 
-/* Prototypes local to this module */
 static WORD
-get_seed(const VwkAttrib * attr, const VwkClip * clip,
-         WORD xin, WORD yin, WORD *xleftout, WORD *xrightout,
-         BOOL seed_type);
+list_take(SeedList *list)
+{
+    WORD i = list->head;
 
+    list->head = seeds[i].next;
+    if (list->head == NOT_FOUND)
+        list->tail = NOT_FOUND;
+
+    return i;
+}
 
-/* common function for line-A linea_fill() and VDI d_countourfill() */
-void contourfill(const VwkAttrib * attr, const VwkClip *clip)
+/*
+ * seen_before - is the section starting at (xleft,y) queued or done?
+ */
+static BOOL
+seen_before(WORD xleft, WORD y)
 {
-    WORD newxleft;              /* ends of line at oldy +       */
-    WORD newxright;             /* the current direction    */
-    WORD oldxleft;              /* left end of line at oldy     */
-    WORD oldxright;             /* right end                    */
-    WORD oldy;                  /* the previous scan line       */
-    WORD xleft;                 /* temporary endpoints          */
-    WORD xright;                /* */
-    WORD direction;             /* is next scan line up or down */
-    BOOL notdone;               /* does seedpoint==search_color */
-    WORD gotseed;               /* 1 => seed was put in the Q */
-                                 /* 0 => no seed was put in the Q */
-                                 /* -1 => queue overflowed */
+    WORD i;
+
+    for (i = seed_hash[SEED_BUCKET(y, xleft)]; i != NOT_FOUND; i = seeds[i].hnext) {
+        if (seeds[i].y == y && seeds[i].xleft == xleft)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+ * put_seed - append a section to the queue
+ *
+ * Returns FALSE if the queue is full.
+ */
+static BOOL
+put_seed(WORD xleft, WORD xright, WORD y)
+{
+    WORD i, *link;
+    Seed *s;
+
+    if (qfree != NOT_FOUND) {
+        i = qfree;
+        qfree = seeds[i].next;
+    } else if (done.head != NOT_FOUND) {
+        /* forget the oldest section done */
+        i = list_take(&done);
+        link = &seed_hash[SEED_BUCKET(seeds[i].y, seeds[i].xleft)];
+        while (*link != i)
+            link = &seeds[*link].hnext;
+        *link = seeds[i].hnext;
+    } else {
+        return FALSE;           /* all still to be drawn */
+    }
+
+    s = &seeds[i];
+    s->y = y;
+    s->xleft = xleft;
+    s->xright = xright;
+    link = &seed_hash[SEED_BUCKET(y, xleft)];
+    s->hnext = *link;
+    *link = i;
+    list_append(&queue, i);
+
+    return TRUE;
+}
+
+/*
+ * get_seeds - queue the new sections to fill on scan line y, that touch
+ * the pixels from xleft to xright
+ *
+ * Returns FALSE if some of them had to be dropped, the queue being full.
+ */
+static BOOL
+get_seeds(const VwkClip * clip, WORD xleft, WORD xright, WORD y, BOOL seed_type)
+{
+    WORD x, left, right;
+    BOOL all = TRUE;
+
+    if (y < clip->ymn_clip || y > clip->ymx_clip)
+        return TRUE;
+
+    for (x = xleft; x <= xright; x = right + 1) {
+        /* a section not to fill is skipped as a whole, too */
+        if (end_pts(clip, x, y, &left, &right, seed_type)
+            && !seen_before(left, y)
+            && !put_seed(left, right, y))
+            all = FALSE;
+    }
+
+    return all;
+}
+
+
+/*
+ * contourfill - common function for line-A linea_fill() and VDI
+ * d_countourfill()
+ *
+ * This is a span fill: starting with the section through the seed point,
+ * every section taken out of the queue is drawn, and the sections of the
+ * scan lines above and below touching it are queued in turn.  Each
+ * section is found with a single scan of its row by the backend (see
+ * end_pts()).
+ *
+ * If the queue overflows, the sections that don't fit are dropped but
+ * the fill goes on with those queued, so that everything not reached
+ * only through a dropped section is still filled.  FALSE is returned
+ * then, the fill being incomplete.  Neither v_contourfill() nor the
+ * line-A fill has a way to pass that on to the application.
+ */
+BOOL contourfill(const VwkAttrib * attr, const VwkClip *clip)
+{
+    WORD x, y;                  /* the seed point */
+    WORD xleft, xright;         /* ends of the section being drawn */
     BOOL seed_type;             /* indicates the type of fill */
+    BOOL complete = TRUE;
 
-    xleft = PTSIN[0];
-    oldy = PTSIN[1];
+    x = PTSIN[0];
+    y = PTSIN[1];
 
-    if (xleft < clip->xmn_clip || xleft > clip->xmx_clip ||
-        oldy < clip->ymn_clip  || oldy > clip->ymx_clip)
-        return;
+    if (x < clip->xmn_clip || x > clip->xmx_clip ||
+        y < clip->ymn_clip || y > clip->ymx_clip)
+        return TRUE;
 
     search_color = INTIN[0];
 
     if ((WORD)search_color < 0) {
-        search_color = pixelread(xleft,oldy);
+        search_color = pixelread(x, y);
         seed_type = 1;
     } else {
         /* Range check the color and convert the index to a pixel value */
         if (search_color >= linea_vars.DEV_TAB[13])
-            return;
+            return TRUE;
 
 #if CONF_WITH_VDI_BACKEND_TRUECOLOR
         if (vdi_screen_is_truecolor()) {
@@ -927,8 +1306,8 @@ void contourfill(const VwkAttrib * attr, const VwkClip *clip)
              *
              * Audited under issue #171: this is the palette-index-choice
              * exception documented on vdi_screen_is_truecolor() itself --
-             * picking which value the already-dispatched search_right()/
-             * search_left() are asked to match, not a primitive.
+             * picking which value the already-dispatched scan_run() is
+             * asked to match, not a primitive.
              */
             search_color = MAP_COL[search_color];
         } else
@@ -951,142 +1330,35 @@ void contourfill(const VwkAttrib * attr, const VwkClip *clip)
     /* Initialize the line drawing parameters */
     linea_vars.LSTLIN = FALSE;
 
-    notdone = end_pts(clip, xleft, oldy, &oldxleft, &oldxright, seed_type);
+    if (!end_pts(clip, x, y, &xleft, &xright, seed_type))
+        return TRUE;            /* nothing to fill at the seed point */
 
-    qptr = qbottom = 0;
-    qtop = 3;                   /* one above highest seed point */
-    queue[0] = (oldy | DOWN_FLAG);
-    queue[1] = oldxleft;
-    queue[2] = oldxright;           /* stuff a point going down into the Q */
+    init_queue();
+    put_seed(xleft, xright, y);
 
-    if (notdone) {
-        /* couldn't get point out of Q or draw it */
-        while (1) {
-            Rect rect;
+    while (queue.head != NOT_FOUND) {
+        WORD i = list_take(&queue);
+        Rect rect;
 
-            direction = (oldy & DOWN_FLAG) ? 1 : -1;
-            gotseed = get_seed(attr, clip, oldxleft, (oldy + direction),
-                               &newxleft, &newxright, seed_type);
-            if (gotseed < 0)
-                return;         /* error, quit */
-
-            if ((newxleft < (oldxleft - 1)) && gotseed) {
-                xleft = oldxleft;
-                while (xleft > newxleft) {
-                    --xleft;
-                    if (get_seed(attr, clip, xleft, oldy ^ DOWN_FLAG,
-                             &xleft, &xright, seed_type) < 0)
-                        return; /* error, quit */
-                }
-            }
-            while (newxright < oldxright) {
-                ++newxright;
-                gotseed = get_seed(attr, clip, newxright, oldy + direction,
-                                   &xleft, &newxright, seed_type);
-                if (gotseed < 0)
-                    return;     /* error, quit */
-            }
-            if ((newxright > (oldxright + 1)) && gotseed) {
-                xright = oldxright;
-                while (xright < newxright) {
-                    ++xright;
-                    if (get_seed(attr, clip, xright, oldy ^ DOWN_FLAG,
-                             &xleft, &xright, seed_type) < 0)
-                        return; /* error, quit */
-                }
-            }
+        list_append(&done, i);
+        rect.x1 = xleft = seeds[i].xleft;
+        rect.y1 = y = seeds[i].y;
+        rect.x2 = xright = seeds[i].xright;
+        rect.y2 = y;
 
-            /* Eventually jump out here */
-            if (qtop == qbottom)
-                break;
+        /* rectangle fill routine draws horizontal line */
+        draw_rect_common(attr, &rect);
 
-            while (queue[qptr] == EMPTY) {
-                qptr += 3;
-                if (qptr == qtop)
-                    qptr = qbottom;
-            }
-
-            oldy = queue[qptr];
-            queue[qptr++] = EMPTY;
-            oldxleft = queue[qptr++];
-            oldxright = queue[qptr++];
-            if (qptr == qtop)
-                crunch_queue();
-
-            rect.x1 = oldxleft;
-            rect.y1 = ABS(oldy);
-            rect.x2 = oldxright;
-            rect.y2 = ABS(oldy);
-
-            /* rectangle fill routine draws horizontal line */
-            draw_rect_common(attr, &rect);
-        }
+        if (!get_seeds(clip, xleft, xright, y - 1, seed_type))
+            complete = FALSE;
+        if (!get_seeds(clip, xleft, xright, y + 1, seed_type))
+            complete = FALSE;
     }
-}                               /* end of fill() */
-
-/*
- * crunch_queue - move qtop down to remove unused seeds
- */
-static void
-crunch_queue(void)
-{
-    while ((queue[qtop - 3] == EMPTY) && (qtop > qbottom))
-        qtop -= 3;
-    if (qptr >= qtop)
-        qptr = qbottom;
-}
 
-/*
- * get_seed - put seeds into Q, if (xin,yin) is not of search_color
- */
-static WORD
-get_seed(const VwkAttrib * attr, const VwkClip * clip,
-         WORD xin, WORD yin, WORD *xleftout, WORD *xrightout,
-         BOOL seed_type)
-{
-    if (end_pts(clip, xin, ABS(yin), xleftout, xrightout, seed_type)) {
-        /* false if of search_color */
-        for (qtmp = qbottom, qhole = NOT_FOUND; qtmp < qtop; qtmp += 3) {
-            /* see, if we ran into another seed */
-            if ( ((queue[qtmp] ^ DOWN_FLAG) == yin) && (queue[qtmp] != EMPTY) &&
-                (queue[qtmp + 1] == *xleftout) )
-
-            {
-                /* we ran into another seed so remove it and fill the line */
-                Rect rect;
-
-                rect.x1 = *xleftout;
-                rect.y1 = ABS(yin);
-                rect.x2 = *xrightout;
-                rect.y2 = ABS(yin);
-
-                /* rectangle fill routine draws horizontal line */
-                draw_rect_common(attr, &rect);
-
-                queue[qtmp] = EMPTY;
-                if ((qtmp + 3) == qtop)
-                    crunch_queue();
-                return 0;
-            }
-            if ((queue[qtmp] == EMPTY) && (qhole == NOT_FOUND))
-                qhole = qtmp;
-        }
-
-        if (qhole == NOT_FOUND) {
-            if ((qtop += 3) > QSIZE) {  /* can't raise qtop ... */
-                KDEBUG(("contourfill(): queue overflow\n"));
-                return -1;      /* error */
-            }
-        } else
-            qtmp = qhole;
-
-        queue[qtmp++] = yin;    /* put the y and endpoints in the Q */
-        queue[qtmp++] = *xleftout;
-        queue[qtmp] = *xrightout;
-        return 1;             /* we put a seed in the Q */
-    }
+    if (!complete)
+        KDEBUG(("contourfill(): incomplete, the queue overflowed\n"));
 
-    return 0;           /* we didn't put a seed in the Q */
+    return complete;
 }
 
 
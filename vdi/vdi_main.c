@@ -118,6 +118,9 @@ void screen(void)
 {
     WORD opcode, handle;
     Vwk *vwk = NULL;
+#if CONF_WITH_VDI_BITMAPS
+    BOOL bitmap;
+#endif
 
     /* get workstation handle */
     handle = CONTRL->handle;
@@ -150,6 +153,16 @@ void screen(void)
     vdi_backend_set_active_vwk(vwk ? vwk : vdi_physical_vwk());
 #endif
 
+#if CONF_WITH_VDI_BITMAPS
+    /* an off-screen bitmap has no mouse cursor to show or hide */
+    bitmap = vwk && vwk->bm_addr;
+    if (bitmap) {
+        if (opcode == 122 || opcode == 123)
+            return;
+        vdi_bitmap_enter(vwk);
+    }
+#endif
+
     if (opcode >= 1 && opcode < 1+JMPTB1_ENTRIES) {
         (*jmptb1[opcode - 1]) (vwk);
     }
@@ -157,4 +170,9 @@ void screen(void)
     else if (opcode >= 100 && opcode < 100+JMPTB2_ENTRIES) {
         (*jmptb2[opcode - 100]) (vwk);
     }
+
+#if CONF_WITH_VDI_BITMAPS
+    if (bitmap)
+        vdi_bitmap_leave();
+#endif
 }
@@ -44,6 +44,34 @@ void (*user_wheel)(WORD wheel_number, WORD wheel_amount);   /* user provided mou
 void (*old_statvec)(UBYTE *);             /* original IKBD status packet routine */
 
 
+#ifdef MACHINE_RPI
+#if CONF_RASPI_MOUSE_CURSOR
+/*
+ * Starts TRUE and latches to FALSE the first time the hardware cursor's
+ * mailbox calls fail (e.g. under QEMU, or firmware that doesn't implement
+ * the cursor property tags). Once latched off, cur_display() stops trying
+ * the hardware cursor and uses the software cursor for the rest of the
+ * session -- a failed mailbox round-trip is not worth repeating on every
+ * draw call.
+ *
+ * While it is available, the hardware cursor is a layer of its own that
+ * the GPU composites over the framebuffer: drawing never touches it, so
+ * there is nothing to save or restore around a drawing operation.
+ * hide_cur() and dis_cur() then merely flag the change, and vb_draw()
+ * passes the current state on to the firmware once per frame.  The
+ * hide/show pair bracketing every AES redraw thus costs no mailbox call
+ * at all when it completes within a frame.
+ */
+static BOOL raspi_hw_cursor_available = TRUE;
+#define cursor_is_layer()   raspi_hw_cursor_available
+#endif
+#endif
+
+#ifndef cursor_is_layer
+#define cursor_is_layer()   FALSE
+#endif
+
+
 #if !CONF_WITH_AES
 /* Default Mouse Cursor Definition */
 static const MFORM arrow_mform = {
@@ -128,8 +156,14 @@ static void dis_cur(void)
     linea_vars.mouse_flag += 1;            /* disable mouse redrawing */
     linea_vars.HIDE_CNT -= 1;   /* decrement hide operations counter */
     if (linea_vars.HIDE_CNT == 0) {
-        cur_display(&linea_vars.mouse_cdb, mcs_ptr, linea_vars.GCURX, linea_vars.GCURY);  /* display the cursor */
-        linea_vars.draw_flag = 0;          /* disable vbl drawing routine */
+        if (cursor_is_layer()) {
+            linea_vars.newx = linea_vars.GCURX;    /* let vb_draw() show it */
+            linea_vars.newy = linea_vars.GCURY;
+            linea_vars.draw_flag = 1;
+        } else {
+            cur_display(&linea_vars.mouse_cdb, mcs_ptr, linea_vars.GCURX, linea_vars.GCURY);  /* display the cursor */
+            linea_vars.draw_flag = 0;      /* disable vbl drawing routine */
+        }
     }
     else if (linea_vars.HIDE_CNT < 0) {
         linea_vars.HIDE_CNT = 0;           /* hide counter should not become negative */
@@ -163,8 +197,12 @@ static void hide_cur(void)
      */
     linea_vars.HIDE_CNT += 1;   /* increment it */
     if (linea_vars.HIDE_CNT == 1) {        /* if cursor was not hidden... */
-        cur_replace(mcs_ptr);   /* remove the cursor from screen */
-        linea_vars.draw_flag = 0;          /* disable vbl drawing routine */
+        if (cursor_is_layer()) {
+            linea_vars.draw_flag = 1;      /* let vb_draw() hide it */
+        } else {
+            cur_replace(mcs_ptr);   /* remove the cursor from screen */
+            linea_vars.draw_flag = 0;      /* disable vbl drawing routine */
+        }
     }
 
     linea_vars.mouse_flag -= 1;            /* re-enable mouse drawing */
@@ -730,6 +768,32 @@ void vdimouse_exit(void)
 
 
 
+#if defined(MACHINE_RPI) && CONF_RASPI_MOUSE_CURSOR
+/*
+ * hw_cursor_update - bring the hardware cursor layer up to date
+ *
+ * Called from vb_draw() for any change of position or visibility.  A
+ * change that arrives while a hide/show operation is in progress is
+ * retried on the next frame, so that the layer never ends up in a stale
+ * state.  If the firmware call fails, cur_display() latches the hardware
+ * cursor off and draws the software cursor instead.
+ */
+static void hw_cursor_update(void)
+{
+    if (linea_vars.mouse_flag) {
+        linea_vars.draw_flag = TRUE;    /* try again next frame */
+        return;
+    }
+
+    if (linea_vars.HIDE_CNT == 0)
+        cur_display(&linea_vars.mouse_cdb, mcs_ptr, linea_vars.newx, linea_vars.newy);
+    else if (!raspi_hw_cur_hide())
+        raspi_hw_cursor_available = FALSE;
+}
+#endif
+
+
+
 /*
  * vb_draw - moves mouse cursor, GEM VBL routine
  *
@@ -757,9 +821,17 @@ static void vb_draw(void)
     if (linea_vars.draw_flag) {
         linea_vars.draw_flag = FALSE;
         enable_interrupts();
+#if defined(MACHINE_RPI) && CONF_RASPI_MOUSE_CURSOR
+        if (cursor_is_layer()) {
+            hw_cursor_update();
+            return;
+        }
+#endif
         if (!linea_vars.mouse_flag) {
             cur_replace(mcs_ptr);       /* remove the old cursor from the screen */
             cur_display(&linea_vars.mouse_cdb, mcs_ptr, linea_vars.newx, linea_vars.newy);  /* display the cursor */
+        } else {
+            linea_vars.draw_flag = TRUE;    /* try again next frame */
         }
     } else
         enable_interrupts();
@@ -887,20 +959,6 @@ static struct {
 } mouse_save;
 #endif
 
-#ifdef MACHINE_RPI
-#if CONF_RASPI_MOUSE_CURSOR
-/*
- * Starts TRUE and latches to FALSE the first time the hardware cursor's
- * mailbox calls fail (e.g. under QEMU, or firmware that doesn't implement
- * the cursor property tags). Once latched off, cur_display() stops trying
- * the hardware cursor and uses the software cursor for the rest of the
- * session -- a failed mailbox round-trip is not worth repeating on every
- * draw call.
- */
-static BOOL raspi_hw_cursor_available = TRUE;
-#endif
-#endif
-
 #if CONF_WITH_VDI_BACKEND_TRUECOLOR
 /*
  * Save the pixel at addr8 into *save and draw the cursor colour there when
@@ -20,6 +20,7 @@
 #include "../bios/tosvars.h"
 #include "../bios/machine.h"    /* for blitter-related items */
 #include "../bios/processor.h"  /* for cache control routines */
+#include "string.h"
 #include "kprint.h"
 
 #if defined(__mcoldfire__) || defined(__arm__)
@@ -117,20 +118,6 @@ static const UBYTE skew_flags[8] = {
 #define YMAX_D  7       /* y of lower right of destination rectangle */
 
 
-/* Raster definitions */
-typedef struct {
-    void *fd_addr;
-    WORD fd_w;
-    WORD fd_h;
-    WORD fd_wdwidth;
-    WORD fd_stand;
-    WORD fd_nplanes;
-    WORD fd_r1;
-    WORD fd_r2;
-    WORD fd_r3;
-} MFDB;
-
-
 extern void linea_blit(struct blit_frame *info); /* called only from linea.S */
 extern void linea_raster(void); /* called only from linea.S */
 #if ASM_BLIT_IS_AVAILABLE
@@ -433,6 +420,109 @@ do_blit(blit * blt)
     } while(--blt->y_cnt != 0);
     /* blt->status &= ~BUSY; */
 }
+
+/*
+ * fast_blit() - word group fast path of the blitter emulation
+ *
+ * do_blit() emulates the blitter one plane at a time, with the source
+ * shifting and the op switch inside its inner loop.  The common cases
+ * need neither: window moves are source-only copies where source and
+ * destination have the same alignment, and the solid fills, XOR and
+ * colour expansion of replace mode only use ops that are affine in S
+ * and D, i.e. out = (S & s_mask) ^ (D & d_mask) ^ invert.  For those,
+ * the op of each plane reduces to three masks, computed once, and each
+ * word group is processed for all planes at once.  The interior of an
+ * interleaved-plane line copy is a single memmove().
+ *
+ * The start addresses, increments and end masks are those of bit_blt(),
+ * so the direction (and hence the handling of overlaps) is the same.
+ * Returns FALSE if the blit must go through do_blit().
+ */
+#define MAX_FAST_PLANES 8
+
+static BOOL
+fast_blit(const blit *blt, ULONG s_addr, ULONG d_addr, WORD skew)
+{
+    UWORD s_mask[MAX_FAST_PLANES], d_mask[MAX_FAST_PLANES], invert[MAX_FAST_PLANES];
+    const WORD planes = blit_info->plane_ct;
+    const WORD s_nxpl = blit_info->s_nxpl, d_nxpl = blit_info->d_nxpl;
+    const WORD x_cnt = blt->x_cnt;
+    BOOL use_src = FALSE, copy = TRUE;
+    WORD plane, x, y, inner = 0;
+
+    if (planes > MAX_FAST_PLANES)
+        return FALSE;
+
+    for (plane = 0; plane < planes; plane++) {
+        WORD op_tabidx, op, k, sc, dc;
+
+        op_tabidx = ((blit_info->fg_col>>plane) & 0x0001 ) <<1;
+        op_tabidx |= (blit_info->bg_col>>plane) & 0x0001;
+        op = blit_info->op_tab[op_tabidx] & 0x000f;
+
+        /* op bits 3..0 are the results for (S,D) = 00, 01, 10, 11 */
+        k = (op >> 3) & 1;
+        sc = ((op >> 1) ^ k) & 1;
+        dc = ((op >> 2) ^ k) & 1;
+        if ((op & 1) != (k ^ sc ^ dc))
+            return FALSE;               /* not affine, e.g. S_OR_D */
+
+        s_mask[plane] = -sc;
+        d_mask[plane] = -dc;
+        invert[plane] = -k;
+        if (sc)
+            use_src = TRUE;
+        if (op != BM_S_ONLY)
+            copy = FALSE;
+    }
+
+    if (use_src && skew)
+        return FALSE;
+
+    /* interleaved planes on both sides: the inner groups of a line are contiguous */
+    if (copy && x_cnt > 2 && s_nxpl == 2 && d_nxpl == 2
+     && blit_info->s_nxwd == 2 * planes && blit_info->d_nxwd == 2 * planes)
+        inner = x_cnt - 2;
+
+    for (y = blit_info->b_ht; y > 0; y--) {
+        for (x = 1; ; x++) {
+            UWORD mask = (x == 1) ? blt->end_1 : (x == x_cnt) ? blt->end_3 : blt->end_2;
+            UBYTE *sp = (UBYTE *)s_addr, *dp = (UBYTE *)d_addr;
+
+            for (plane = 0; plane < planes; plane++, sp += s_nxpl, dp += d_nxpl) {
+                UWORD dst = *(UWORD *)dp;
+                UWORD out = (dst & d_mask[plane]) ^ invert[plane];
+
+                if (use_src)
+                    out ^= *(UWORD *)sp & s_mask[plane];
+                *(UWORD *)dp = dst ^ ((out ^ dst) & mask);
+            }
+            if (x == x_cnt)
+                break;
+            s_addr += blt->src_x_inc;
+            d_addr += blt->dst_x_inc;
+
+            if (x == 1 && inner) {
+                /* s_addr/d_addr are the first inner group in blit order */
+                LONG s_skip = (LONG)(inner - 1) * blt->src_x_inc;
+                LONG d_skip = (LONG)(inner - 1) * blt->dst_x_inc;
+
+                if (blt->dst_x_inc < 0)
+                    memmove((void *)(d_addr + d_skip), (void *)(s_addr + s_skip),
+                            (ULONG)inner * blit_info->d_nxwd);
+                else
+                    memmove((void *)d_addr, (void *)s_addr, (ULONG)inner * blit_info->d_nxwd);
+                s_addr += s_skip + blt->src_x_inc;
+                d_addr += d_skip + blt->dst_x_inc;
+                x += inner;
+            }
+        }
+        s_addr += blt->src_y_inc;
+        d_addr += blt->dst_y_inc;
+    }
+
+    return TRUE;
+}
 #endif
 
 
@@ -628,6 +718,16 @@ bit_blt (void)
 #define mHOP_Halftone 0x01
     blt->hop = mHOP_Source;   /* word */    /* set HOP to source only */
 
+#if !ASM_BLIT_IS_AVAILABLE
+#if CONF_WITH_BLITTER
+    if (!blitter_is_enabled)
+#endif
+    {
+        if (fast_blit(blt, s_addr, d_addr, skew))
+            return;
+    }
+#endif
+
     for (plane = 0; plane < blit_info->plane_ct; plane++) {
         int op_tabidx;
 
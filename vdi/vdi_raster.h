@@ -98,6 +98,19 @@ struct raster_t {
     UWORD bg_col;
 };
 
+/* Raster definitions */
+typedef struct {
+    void *fd_addr;
+    WORD fd_w;
+    WORD fd_h;
+    WORD fd_wdwidth;
+    WORD fd_stand;
+    WORD fd_nplanes;
+    WORD fd_r1;
+    WORD fd_r2;
+    WORD fd_r3;
+} MFDB;
+
 /*
  * Planar raster-copy backend: dispatches info (already fully set up by
  * cpy_raster()) to the hardware blitter or its C/assembler emulation.